@@ -0,0 +1,137 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * Arena allocator for memory whose pieces die together.
+ *
+ * Bump-pointer allocation from large blocks.  Nothing is freed on
+ * its own.  arenaRelease drops everything allocated since a mark taken
+ * with arenaMark in one step, and freeArena drops it all.  Emptied blocks
+ * go on a spare list and are handed out again before malloc is asked for
+ * more.  So work that marks, allocates and releases over and over (a
+ * file in a batch, a re-lexed edit) settles into using no malloc at all.
+ * The interner keeps its strings in one, each lexer context has one for
+ * per-file scratch such as token windows (lexctx.h), and the concurrent
+ * table's writers keep their entries in one, as does the binding pool of
+ * the scoped symbol tables (scope.h).
+ *
+ * With LEXER_STATS the arena counts its work: blocks taken from malloc and
+ * from the spare list, and bytes handed out and released.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Per-thread counters (lexstats.h).
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#include "lexstats.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used, size;
+    _Alignas(ARENA_ALIGN) char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;       // current block; older ones follow
+    size_t bytes;           // total handed out
+    ArenaBlock *spare;      // blocks emptied by arenaRelease, kept for reuse
+} Arena;
+
+// A point to roll an arena back to (see arenaRelease).
+typedef struct {
+    ArenaBlock *block;
+    size_t used, bytes;
+} ArenaMark;
+
+// Make a block with room for n bytes the current one.
+static ArenaBlock *arenaNewBlock(Arena *arena, size_t n) {
+    ArenaBlock *b;
+    if (arena->spare && arena->spare->size >= n) {
+        b = arena->spare;
+        arena->spare = b->next;
+        LEXSTATS(lexStats.arenaSpareBlocks++;)
+    } else {
+        size_t size = n > ARENA_BLOCK_SIZE ? n : ARENA_BLOCK_SIZE;
+        if (!(b = malloc(sizeof(ArenaBlock) + size)))
+            return NULL;
+        b->size = size;
+        LEXSTATS(lexStats.arenaBlocks++;)
+    }
+    b->next = arena->head;
+    b->used = 0;
+    arena->head = b;
+    return b;
+}
+
+// n bytes with no particular alignment (strings).
+static char *arenaAlloc(Arena *arena, size_t n) {
+    ArenaBlock *b = arena->head;
+    if ((!b || b->size - b->used < n) && !(b = arenaNewBlock(arena, n)))
+        return NULL;
+    char *p = b->data + b->used;
+    b->used += n;
+    arena->bytes += n;
+    LEXSTATS(lexStats.arenaBytes += n;)
+    return p;
+}
+
+// n bytes aligned for any struct or array.
+static void *arenaAllocAligned(Arena *arena, size_t n) {
+    ArenaBlock *b = arena->head;
+    size_t pad = b ? (size_t)(0 - (uintptr_t)(b->data + b->used)) & (ARENA_ALIGN - 1) : 0;
+    if (!b || b->size - b->used < pad + n) {
+        if (!(b = arenaNewBlock(arena, n)))
+            return NULL;
+        pad = 0;   // block data is aligned
+    }
+    b->used += pad;
+    arena->bytes += pad;
+    return arenaAlloc(arena, n);
+}
+
+static inline ArenaMark arenaMark(const Arena *arena) {
+    ArenaMark mark = { arena->head, arena->head ? arena->head->used : 0, arena->bytes };
+    return mark;
+}
+
+// Free everything allocated since mark was taken, in LIFO order.  Emptied
+// blocks go on the spare list, so code that repeatedly crosses a block
+// boundary does not call malloc.
+static inline void arenaRelease(Arena *arena, ArenaMark mark) {
+    while (arena->head != mark.block) {
+        ArenaBlock *b = arena->head;
+        arena->head = b->next;
+        b->next = arena->spare;
+        arena->spare = b;
+    }
+    if (mark.block)
+        mark.block->used = mark.used;
+    LEXSTATS(lexStats.arenaReleasedBytes += arena->bytes - mark.bytes;)
+    arena->bytes = mark.bytes;
+}
+
+static void freeBlocks(ArenaBlock *b) {
+    while (b) {
+        ArenaBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+}
+
+static void freeArena(Arena *arena) {
+    freeBlocks(arena->head);
+    freeBlocks(arena->spare);
+    memset(arena, 0, sizeof(*arena));
+}
+
+#endif
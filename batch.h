@@ -0,0 +1,548 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/*
+ * Batch mode: build one merged symbol table for many files in a single
+ * process instead of forking a front end per file.
+ *
+ *     java --batch [--jobs N] [--cache dir] [--shared] [--files-from list] [file | dir]...
+ *     csample --batch --includes [-I dir]... [--jobs N] [--shared] [file | dir]...
+ *
+ * Directories are walked recursively and contribute the files whose suffix
+ * is in the language's extension list; files named on the command line or
+ * in the list file ("-" for stdin, one path per line) are always taken.
+ *
+ * Files are scanned in parallel on a small work-stealing pool.  Every
+ * worker starts with a contiguous slice of the file list and takes files
+ * from the front of it; a worker that runs dry steals the back half of
+ * another worker's remaining slice.  Each worker has a lexer context of
+ * its own (lexctx.h), so it runs the ordinary front end on that and folds
+ * the result into a private table.
+ *
+ * The merged table is the same one a sequential run would produce by
+ * adding the files' tables in list order: for a name declared in several
+ * files the first file in the list wins, and entries are reported by
+ * (file, position in that file).  With --cache, each file's table comes
+ * from the symbol cache (symcache.h) when its content has been seen before.
+ * With --shared, workers declare straight into one lock-free table
+ * (concsym.h) instead of private tables merged at the end.  A declaration's
+ * key there is (file << 32) + its count in the file, so the output is the
+ * same.  With --includes (C only) each file is scanned as a translation
+ * unit, headers and all (incgraph.h).  The workers share one header cache,
+ * so a header is lexed once for the batch however many units include it;
+ * --cache is ignored, since a unit's table depends on more than its own
+ * content.  Build with -pthread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "lexer.h"
+#include "tokbuf.h"
+#include "symcache.h"
+#include "concsym.h"
+#include "incgraph.h"
+
+typedef struct {
+    char **paths;
+    int count, capacity;
+} FileList;
+
+static int addFile(FileList *list, const char *path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        char **paths = realloc(list->paths, capacity * sizeof(char *));
+        if (!paths)
+            return -1;
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+    if (!(list->paths[list->count] = strdup(path)))
+        return -1;
+    list->count++;
+    return 0;
+}
+
+static void freeFileList(FileList *list) {
+    for (int i = 0; i < list->count; i++)
+        free(list->paths[i]);
+    free(list->paths);
+    memset(list, 0, sizeof(*list));
+}
+
+// Does name end in one of the space-separated suffixes in extensions?
+static int hasExtension(const char *name, const char *extensions) {
+    size_t len = strlen(name);
+    for (const char *e = extensions; *e; ) {
+        size_t n = strcspn(e, " ");
+        if (n && n < len && memcmp(name + len - n, e, n) == 0)
+            return 1;
+        e += n;
+        while (*e == ' ')
+            e++;
+    }
+    return 0;
+}
+
+static int pathCompare(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Add the matching files under dir, in sorted order so runs are repeatable.
+static void addDirectory(FileList *list, const char *dir, const char *extensions) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Cannot open %s\n", dir);
+        return;
+    }
+    FileList names = { 0 };
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0)
+            addFile(&names, ent->d_name);
+    }
+    closedir(d);
+    qsort(names.paths, names.count, sizeof(char *), pathCompare);
+
+    size_t dirLen = strlen(dir);
+    for (int i = 0; i < names.count; i++) {
+        size_t len = dirLen + strlen(names.paths[i]) + 2;
+        char *path = malloc(len);
+        if (!path)
+            break;
+        snprintf(path, len, "%s%s%s", dir, dir[dirLen - 1] == '/' ? "" : "/", names.paths[i]);
+        struct stat st;
+        if (stat(path, &st) == 0) {
+            if (S_ISDIR(st.st_mode))
+                addDirectory(list, path, extensions);
+            else if (S_ISREG(st.st_mode) && hasExtension(names.paths[i], extensions))
+                addFile(list, path);
+        }
+        free(path);
+    }
+    freeFileList(&names);
+}
+
+static void addPath(FileList *list, const char *path, const char *extensions) {
+    struct stat st;
+    if (strcmp(path, "-") != 0 && stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+        addDirectory(list, path, extensions);
+    else
+        addFile(list, path);
+}
+
+// One path per line; blank lines are skipped.
+static int addFilesFrom(FileList *list, const char *listPath, const char *extensions) {
+    FILE *fp = strcmp(listPath, "-") == 0 ? stdin : fopen(listPath, "r");
+    if (!fp)
+        return -1;
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0])
+            addPath(list, line, extensions);
+    }
+    if (fp != stdin)
+        fclose(fp);
+    return 0;
+}
+
+/* ---------------------------------------------------------- merged tables */
+
+// Where a merged entry was first declared: list position of the file and
+// index of the entry in that file's own table.
+typedef struct {
+    int file, seq;
+} SymbolOrigin;
+
+typedef struct {
+    SymbolTable table;
+    SymbolOrigin *origins;    // parallel to table.entries
+    int originCapacity;
+} MergedTable;
+
+// Fold one entry into merged, keeping the declaration from the earliest file.
+static void mergeSymbol(MergedTable *merged, const SymbolTableEntry *entry, SymbolOrigin origin) {
+    int added;
+    int idx = internSymbol(&merged->table, entry->nameId, &added);
+    if (idx < 0)
+        return;
+    if (merged->table.capacity > merged->originCapacity) {
+        SymbolOrigin *origins = realloc(merged->origins, merged->table.capacity * sizeof(SymbolOrigin));
+        if (!origins)
+            return;
+        merged->origins = origins;
+        merged->originCapacity = merged->table.capacity;
+    }
+    if (added || origin.file < merged->origins[idx].file) {
+        merged->table.entries[idx] = *entry;
+        merged->origins[idx] = origin;
+    }
+}
+
+static void freeMergedTable(MergedTable *merged) {
+    freeSymbolTable(&merged->table);
+    free(merged->origins);
+    memset(merged, 0, sizeof(*merged));
+}
+
+// A merged entry's index with its origin, sorted so the comparison needs
+// no state outside its arguments.
+typedef struct {
+    SymbolOrigin origin;
+    int index;
+} OrderedSymbol;
+
+static int originCompare(const void *a, const void *b) {
+    const SymbolOrigin *x = &((const OrderedSymbol *)a)->origin, *y = &((const OrderedSymbol *)b)->origin;
+    if (x->file != y->file)
+        return x->file < y->file ? -1 : 1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+// Rebuild merged as ctx's symbol table in sequential-run order.
+static void publishMergedTable(LexerContext *ctx, MergedTable *merged) {
+    int count = merged->table.count;
+    OrderedSymbol *order = malloc((count ? count : 1) * sizeof(OrderedSymbol));
+    if (!order)
+        return;
+    for (int i = 0; i < count; i++) {
+        order[i].origin = merged->origins[i];
+        order[i].index = i;
+    }
+    qsort(order, count, sizeof(OrderedSymbol), originCompare);
+
+    freeSymbolTable(&ctx->symbols);
+    for (int i = 0; i < count; i++) {
+        const SymbolTableEntry *entry = &merged->table.entries[order[i].index];
+        int added;
+        int idx = internSymbol(&ctx->symbols, entry->nameId, &added);
+        if (idx >= 0)
+            ctx->symbols.entries[idx] = *entry;
+    }
+    free(order);
+}
+
+/* ------------------------------------------------------------ worker pool */
+
+typedef struct BatchJob BatchJob;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int next, end;            // remaining slice of the file list
+    BatchJob *job;
+    int id;
+    MergedTable merged;       // points into ctx.strings
+    LexerContext ctx;
+    SymbolWriter *writer;     // --shared: this worker's writer, instead of merged
+    uint64_t nextOrder;       // --shared: key of the worker's next declaration
+    unsigned *declaredIn;     // --shared: by name id, file + 1 that last declared it
+    unsigned declaredCapacity;
+    int writeFailed;          // --shared: out of memory declaring into the table
+    IncludeWalker walker;     // --includes: walks units in ctx
+    int files, failed, cacheHits;
+    pthread_t thread;
+} BatchWorker;
+
+struct BatchJob {
+    const LanguageDescriptor *lang;
+    const FileList *files;
+    BatchWorker *workers;
+    int numWorkers;
+    const char *cacheDir;     // NULL: no symbol cache
+    ConcurrentSymbolTable *shared;   // NULL: no --shared
+    HeaderCache *headers;     // NULL: no --includes
+};
+
+static int takeOwnFile(BatchWorker *w) {
+    int file = -1;
+    pthread_mutex_lock(&w->lock);
+    if (w->next < w->end)
+        file = w->next++;
+    pthread_mutex_unlock(&w->lock);
+    return file;
+}
+
+// Move the back half of some other worker's slice to w; returns the first
+// stolen file, or -1 when every slice is empty (files never add work, so
+// the pool is then finished).
+static int stealFiles(BatchWorker *w) {
+    BatchJob *job = w->job;
+    for (int k = 1; k < job->numWorkers; k++) {
+        BatchWorker *victim = &job->workers[(w->id + k) % job->numWorkers];
+        int from = -1, to = -1;
+        pthread_mutex_lock(&victim->lock);
+        int left = victim->end - victim->next;
+        if (left > 0) {
+            from = victim->end - (left + 1) / 2;
+            to = victim->end;
+            victim->end = from;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (from >= 0) {
+            pthread_mutex_lock(&w->lock);
+            w->next = from + 1;
+            w->end = to;
+            pthread_mutex_unlock(&w->lock);
+            return from;
+        }
+    }
+    return -1;
+}
+
+// Fold the table of the file just scanned, in w->ctx.symbols, into the
+// worker's results.
+static void foldFileSymbols(BatchWorker *w, int file) {
+    for (int i = 0; i < w->ctx.symbols.count; i++) {
+        const SymbolTableEntry *entry = &w->ctx.symbols.entries[i];
+        if (!w->writer)
+            mergeSymbol(&w->merged, entry, (SymbolOrigin){ file, i });
+        else if (addConcurrentSymbol(w->writer, entry->name, strlen(entry->name), entry->type, w->nextOrder++) < 0)
+            w->writeFailed = 1;
+    }
+    resetSymbolTable(&w->ctx.symbols);
+    w->files++;
+}
+
+// LexerContext.declarationHook for lexing straight into the shared table;
+// hookData is the worker.  Within a file, a name's later declarations have
+// bigger keys and could never win, so they are dropped here without
+// touching the table.  The file is the high half of the worker's keys.
+static void declareSharedHook(LexerContext *ctx, unsigned nameId, const char *declType) {
+    BatchWorker *w = ctx->hookData;
+    unsigned file = (unsigned)(w->nextOrder >> 32);
+    if (nameId >= w->declaredCapacity) {
+        unsigned capacity = w->declaredCapacity ? w->declaredCapacity : 256;
+        while (capacity <= nameId)
+            capacity *= 2;
+        unsigned *declaredIn = realloc(w->declaredIn, capacity * sizeof(unsigned));
+        if (!declaredIn) {
+            w->writeFailed = 1;
+            return;
+        }
+        memset(declaredIn + w->declaredCapacity, 0, (capacity - w->declaredCapacity) * sizeof(unsigned));
+        w->declaredIn = declaredIn;
+        w->declaredCapacity = capacity;
+    }
+    if (w->declaredIn[nameId] == file + 1) {
+        LEXSTATS(lexStats.declarations++; lexStats.duplicates++;)
+        return;
+    }
+    w->declaredIn[nameId] = file + 1;
+    if (addConcurrentSymbol(w->writer, internedString(&ctx->strings, nameId), ctx->strings.lengths[nameId],
+                            declType, w->nextOrder++) < 0)
+        w->writeFailed = 1;
+}
+
+static void scanBatchFile(BatchWorker *w, int file) {
+    SourceBuffer src;
+    const char *path = w->job->files->paths[file];
+    if (srcOpen(&src, path) != 0) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        w->failed++;
+        return;
+    }
+    w->nextOrder = (uint64_t)file << 32;
+    if (w->job->cacheDir) {
+        w->cacheHits += cachedSymbolTable(&w->ctx, w->job->lang, &src, w->job->cacheDir);
+    } else if (w->writer) {
+        w->ctx.declarationHook = declareSharedHook;
+        w->ctx.hookData = w;
+        generateSymbolTable(&w->ctx, w->job->lang, &src);
+        w->ctx.declarationHook = NULL;
+        w->ctx.hookData = NULL;
+    } else {
+        generateSymbolTable(&w->ctx, w->job->lang, &src);
+    }
+    foldFileSymbols(w, file);
+    srcClose(&src);
+}
+
+// --includes: the file is a translation unit, walked with its headers.
+static void scanBatchUnit(BatchWorker *w, int file) {
+    const char *path = w->job->files->paths[file];
+    w->nextOrder = (uint64_t)file << 32;
+    if (w->writer) {
+        w->ctx.declarationHook = declareSharedHook;
+        w->ctx.hookData = w;
+    }
+    int status = scanTranslationUnit(&w->walker, path);
+    w->ctx.declarationHook = NULL;
+    w->ctx.hookData = NULL;
+    if (status != 0) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        w->failed++;
+        return;
+    }
+    foldFileSymbols(w, file);
+}
+
+static void *batchWorkerMain(void *arg) {
+    BatchWorker *w = arg;
+    for (;;) {
+        int file = takeOwnFile(w);
+        if (file < 0 && (file = stealFiles(w)) < 0)
+            break;
+        if (w->job->headers)
+            scanBatchUnit(w, file);
+        else
+            scanBatchFile(w, file);
+    }
+    LEXSTATS(mergeLexStats();)
+    return NULL;
+}
+
+static int defaultJobs(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+int runBatch(const LanguageDescriptor *lang, int argc, char *argv[]) {
+    FileList files = { 0 };
+    const char *cacheDir = NULL;
+    int jobs = defaultJobs(), shared = 0, includes = 0;
+    HeaderCache headers;
+    if (initHeaderCache(&headers, lang) != 0)
+        return 1;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (strcmp(argv[i], "--shared") == 0) {
+            shared = 1;
+        } else if (strcmp(argv[i], "--includes") == 0 && lang->directives) {
+            includes = 1;
+        } else if (strcmp(argv[i], "-I") == 0 && i + 1 < argc && lang->directives) {
+            addIncludeDir(&headers, argv[++i]);
+        } else if (strncmp(argv[i], "-I", 2) == 0 && argv[i][2] && lang->directives) {
+            addIncludeDir(&headers, argv[i] + 2);
+        } else if (strcmp(argv[i], "--files-from") == 0 && i + 1 < argc) {
+            if (addFilesFrom(&files, argv[++i], lang->extensions) != 0) {
+                printf("Cannot open %s\n", argv[i]);
+                freeFileList(&files);
+                freeHeaderCache(&headers);
+                return 1;
+            }
+        } else {
+            addPath(&files, argv[i], lang->extensions);
+        }
+    }
+    if (includes)
+        cacheDir = NULL;   // the content key does not cover the headers
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > files.count)
+        jobs = files.count ? files.count : 1;
+
+    struct timespec start, stop;
+    timespec_get(&start, TIME_UTC);
+
+    ConcurrentSymbolTable sharedTable;
+    BatchJob job = { lang, &files, calloc(jobs, sizeof(BatchWorker)), jobs, cacheDir, NULL,
+                     includes ? &headers : NULL };
+    if (job.workers && shared && initConcurrentSymbolTable(&sharedTable) == 0) {
+        job.shared = &sharedTable;
+        for (int i = 0; i < jobs && job.shared; i++) {
+            if (!(job.workers[i].writer = openSymbolWriter(job.shared))) {
+                freeConcurrentSymbolTable(job.shared);
+                job.shared = NULL;
+            }
+        }
+    }
+    if (!job.workers || (shared && !job.shared)) {
+        free(job.workers);
+        freeFileList(&files);
+        freeHeaderCache(&headers);
+        return 1;
+    }
+    for (int i = 0; i < jobs; i++) {
+        BatchWorker *w = &job.workers[i];
+        pthread_mutex_init(&w->lock, NULL);
+        w->job = &job;
+        w->id = i;
+        initLexerContext(&w->ctx);
+        initIncludeWalker(&w->walker, job.headers, &w->ctx);
+        w->next = (int)((long long)files.count * i / jobs);
+        w->end = (int)((long long)files.count * (i + 1) / jobs);
+    }
+    // The whole batch is one run over the header cache: a header's stamp is
+    // checked the first time any worker reaches it, and not again.
+    if (job.headers)
+        beginHeaderRun(job.headers);
+    // Worker 0 runs on this thread.
+    for (int i = 1; i < jobs; i++) {
+        if (pthread_create(&job.workers[i].thread, NULL, batchWorkerMain, &job.workers[i]) != 0)
+            job.workers[i].thread = pthread_self();
+    }
+    batchWorkerMain(&job.workers[0]);
+
+    for (int i = 1; i < jobs; i++) {
+        if (!pthread_equal(job.workers[i].thread, pthread_self()))
+            pthread_join(job.workers[i].thread, NULL);
+    }
+
+    LexerContext ctx;
+    MergedTable merged = { 0 };
+    initLexerContext(&ctx);
+    int scanned = 0, failed = 0, cacheHits = 0;
+    for (int i = 0; i < jobs; i++) {
+        BatchWorker *w = &job.workers[i];
+        for (int k = 0; k < w->merged.table.count; k++) {
+            // Re-intern into one pool so ids are comparable.
+            SymbolTableEntry entry = w->merged.table.entries[k];
+            entry.nameId = internString(&ctx.strings, entry.name, strlen(entry.name));
+            entry.name = internedString(&ctx.strings, entry.nameId);
+            entry.type = intern(&ctx.strings, entry.type);
+            mergeSymbol(&merged, &entry, w->merged.origins[k]);
+        }
+        scanned += w->files;
+        failed += w->failed + w->writeFailed;
+        cacheHits += w->cacheHits;
+        freeMergedTable(&w->merged);
+        free(w->declaredIn);
+        freeIncludeWalker(&w->walker);
+        freeLexerContext(&w->ctx);
+        pthread_mutex_destroy(&w->lock);
+    }
+    if (job.shared) {
+        if (concurrentSymbolsToTable(job.shared, &ctx.symbols, &ctx.strings) < 0)
+            failed++;
+        freeConcurrentSymbolTable(job.shared);
+    } else {
+        publishMergedTable(&ctx, &merged);
+    }
+    freeMergedTable(&merged);
+
+    timespec_get(&stop, TIME_UTC);
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    printSymbolTable(&ctx, lang);
+    fprintf(stderr, "%d files scanned, %d failed, %d symbols, %d threads, %.3f s",
+            scanned, failed, ctx.symbols.count, jobs, seconds);
+    if (cacheDir)
+        fprintf(stderr, ", %d cache hits", cacheHits);
+    if (includes)
+        fprintf(stderr, ", %d header cache hits, %d misses", atomic_load(&headers.hits),
+                atomic_load(&headers.misses));
+    fprintf(stderr, "\n");
+
+    freeLexerContext(&ctx);
+    freeHeaderCache(&headers);
+    free(job.workers);
+    freeFileList(&files);
+    return failed ? 1 : 0;
+}
+
+#endif
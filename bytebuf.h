@@ -0,0 +1,45 @@
+#ifndef BYTEBUF_H
+#define BYTEBUF_H
+
+/*
+ * Growable byte buffer for the file writers (symcache.h, tokwrite.h),
+ * which build a whole file in memory before writing it out.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char *data;
+    size_t len, capacity;
+} ByteBuffer;
+
+// Make room for n more bytes.
+static int reserveBytes(ByteBuffer *b, size_t n) {
+    if (b->len + n <= b->capacity)
+        return 0;
+    size_t capacity = b->capacity ? b->capacity * 2 : 4096;
+    while (capacity < b->len + n)
+        capacity *= 2;
+    char *grown = realloc(b->data, capacity);
+    if (!grown)
+        return -1;
+    b->data = grown;
+    b->capacity = capacity;
+    return 0;
+}
+
+static int appendBytes(ByteBuffer *b, const void *data, size_t len) {
+    if (reserveBytes(b, len) != 0)
+        return -1;
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return 0;
+}
+
+static int alignBytes(ByteBuffer *b) {
+    static const char zeros[8] = { 0 };
+    return appendBytes(b, zeros, (8 - b->len % 8) % 8);
+}
+
+#endif
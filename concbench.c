@@ -0,0 +1,332 @@
+// Stress test and scaling benchmark for the lock-free symbol table
+// (concsym.h).
+//
+//     gcc -O2 -pthread concbench.c -o concbench
+//     ./concbench [--threads N] [--names N] [--declarations N] [--rounds N] [--stress]
+//
+// The workload is a fixed sequence of declarations of --names distinct
+// names (200000 by default), --declarations long (1000000): declaration j
+// names a pseudo-random name with one of a few types and has order key j.
+// Thread t of T declares every j with j % T == t, so threads keep racing on
+// the same names, and every table starts small so it resizes many times
+// while they do.
+//
+// --stress runs --rounds rounds (default 20) on 1..--threads threads and
+// checks each one.  After every insert, the writer looks its name up
+// again, which must find it even in the middle of a resize.  The final
+// table must match a sequential run: the same names, and for each the
+// type of its smallest key, in key order.
+//
+// Otherwise it times the workload on 1, 2, 4, ... up to --threads threads
+// (the number of CPUs by default).  For each it compares the lock-free
+// table with the plain symbol table and interner behind one mutex.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "concsym.h"
+
+static const char *const types[] = { "function", "variable", "int", "const", "let" };
+#define NUM_TYPES (sizeof(types) / sizeof(types[0]))
+
+typedef struct {
+    char **names;
+    unsigned *lengths;
+    unsigned numNames;
+    unsigned *sequence;      // name of each declaration
+    size_t numDecls;
+} Workload;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+static int makeWorkload(Workload *wl, unsigned numNames, size_t numDecls) {
+    memset(wl, 0, sizeof(*wl));
+    wl->names = malloc(numNames * sizeof(char *));
+    wl->lengths = malloc(numNames * sizeof(unsigned));
+    wl->sequence = malloc(numDecls * sizeof(unsigned));
+    if (!wl->names || !wl->lengths || !wl->sequence)
+        return -1;
+    for (unsigned i = 0; i < numNames; i++) {
+        char name[48];
+        // Short and long names, like real code.
+        int len = i % 4 == 0 ? snprintf(name, sizeof(name), "n%u", i)
+                             : snprintf(name, sizeof(name), "%s_%u", i % 4 == 1 ? "count" : "handleRequest", i);
+        if (!(wl->names[i] = strdup(name)))
+            return -1;
+        wl->lengths[i] = (unsigned)len;
+        wl->numNames++;
+    }
+    for (size_t j = 0; j < numDecls; j++)
+        wl->sequence[j] = (unsigned)(mix64(j + 1) % numNames);
+    wl->numDecls = numDecls;
+    return 0;
+}
+
+static void freeWorkload(Workload *wl) {
+    for (unsigned i = 0; i < wl->numNames; i++)
+        free(wl->names[i]);
+    free(wl->names);
+    free(wl->lengths);
+    free(wl->sequence);
+}
+
+/* ------------------------------------------------------------------ runs */
+
+typedef struct {
+    const Workload *wl;
+    int id, threads;
+    int stress;
+    ConcurrentSymbolTable *table;
+    SymbolWriter *writer;
+    // Mutex baseline.
+    pthread_mutex_t *lock;
+    Interner *pool;
+    SymbolTable *locked;
+    uint64_t *lockedOrders;
+    long errors;
+    pthread_t thread;
+} Runner;
+
+static void *runLockFree(void *arg) {
+    Runner *r = arg;
+    const Workload *wl = r->wl;
+    for (size_t j = (size_t)r->id; j < wl->numDecls; j += (size_t)r->threads) {
+        unsigned n = wl->sequence[j];
+        if (addConcurrentSymbol(r->writer, wl->names[n], wl->lengths[n], types[j % NUM_TYPES], j) < 0) {
+            r->errors++;
+            break;
+        }
+        if (r->stress && !findConcurrentSymbol(r->table, wl->names[n]))
+            r->errors++;
+    }
+    return NULL;
+}
+
+static void *runLocked(void *arg) {
+    Runner *r = arg;
+    const Workload *wl = r->wl;
+    for (size_t j = (size_t)r->id; j < wl->numDecls; j += (size_t)r->threads) {
+        unsigned n = wl->sequence[j];
+        int added;
+        pthread_mutex_lock(r->lock);
+        unsigned id = internString(r->pool, wl->names[n], wl->lengths[n]);
+        int idx = id ? internSymbol(r->locked, id, &added) : -1;
+        if (idx < 0) {
+            r->errors++;
+        } else if (added || j < r->lockedOrders[idx]) {
+            fillSymbolEntry(&r->locked->entries[idx], id, internedString(r->pool, id), types[j % NUM_TYPES]);
+            r->lockedOrders[idx] = j;
+        }
+        pthread_mutex_unlock(r->lock);
+    }
+    return NULL;
+}
+
+// Run fn on threads runners; returns the wall time.
+static double runThreads(Runner *runners, int threads, void *(*fn)(void *)) {
+    double start = nowSeconds();
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&runners[i].thread, NULL, fn, &runners[i]) != 0)
+            runners[i].thread = pthread_self();
+    }
+    fn(&runners[0]);
+    for (int i = 1; i < threads; i++) {
+        if (pthread_equal(runners[i].thread, pthread_self()))
+            fn(&runners[i]);
+        else
+            pthread_join(runners[i].thread, NULL);
+    }
+    return nowSeconds() - start;
+}
+
+// Lock-free run on threads threads; fills result (interned in strings)
+// with the final table if given.
+static double timeLockFree(const Workload *wl, int threads, int stress, SymbolTable *result, Interner *strings,
+                           long *errors) {
+    ConcurrentSymbolTable table;
+    Runner *runners = calloc(threads, sizeof(Runner));
+    if (!runners || initConcurrentSymbolTable(&table) != 0) {
+        free(runners);
+        (*errors)++;
+        return 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        runners[i] = (Runner){ .wl = wl, .id = i, .threads = threads, .stress = stress, .table = &table };
+        if (!(runners[i].writer = openSymbolWriter(&table)))
+            (*errors)++;
+    }
+    double seconds = *errors ? 0 : runThreads(runners, threads, runLockFree);
+    for (int i = 0; i < threads; i++)
+        *errors += runners[i].errors;
+    if (result && concurrentSymbolsToTable(&table, result, strings) < 0)
+        (*errors)++;
+    freeConcurrentSymbolTable(&table);
+    free(runners);
+    return seconds;
+}
+
+static double timeLocked(const Workload *wl, int threads, long *errors) {
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    Interner pool = { 0 };
+    SymbolTable locked = { 0 };
+    uint64_t *orders = malloc(wl->numNames * sizeof(uint64_t));
+    Runner *runners = calloc(threads, sizeof(Runner));
+    if (!orders || !runners) {
+        free(orders);
+        free(runners);
+        (*errors)++;
+        return 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        runners[i] = (Runner){ .wl = wl, .id = i, .threads = threads, .lock = &lock, .pool = &pool,
+                               .locked = &locked, .lockedOrders = orders };
+    }
+    double seconds = runThreads(runners, threads, runLocked);
+    for (int i = 0; i < threads; i++)
+        *errors += runners[i].errors;
+    freeSymbolTable(&locked);
+    freeInterner(&pool);
+    free(orders);
+    free(runners);
+    return seconds;
+}
+
+/* ---------------------------------------------------------------- checks */
+
+// Compare table with a sequential run of the workload.  Returns the number
+// of differences.
+static long checkTable(const Workload *wl, const SymbolTable *table) {
+    size_t *first = malloc(wl->numNames * sizeof(size_t));
+    if (!first)
+        return 1;
+    for (unsigned n = 0; n < wl->numNames; n++)
+        first[n] = SIZE_MAX;
+    int expected = 0;
+    long bad = 0;
+    for (size_t j = 0; j < wl->numDecls; j++) {
+        unsigned n = wl->sequence[j];
+        if (first[n] == SIZE_MAX) {
+            first[n] = j;
+            // Names come out in key order, so this is entry number expected.
+            const SymbolTableEntry *e = expected < table->count ? &table->entries[expected] : NULL;
+            if (!e || strcmp(e->name, wl->names[n]) != 0 || strcmp(e->type, types[j % NUM_TYPES]) != 0)
+                bad++;
+            expected++;
+        }
+    }
+    if (table->count != expected)
+        bad++;
+    free(first);
+    return bad;
+}
+
+static int runStress(const Workload *wl, int maxThreads, int rounds) {
+    long failures = 0;
+    for (int round = 0; round < rounds; round++) {
+        int threads = 1 + round % maxThreads;
+        SymbolTable table = { 0 };
+        Interner strings = { 0 };
+        long errors = 0;
+        timeLockFree(wl, threads, 1, &table, &strings, &errors);
+        long bad = checkTable(wl, &table);
+        if (errors || bad) {
+            printf("round %d, %d threads: %ld failed inserts or lookups, %ld table differences\n", round, threads,
+                   errors, bad);
+            failures++;
+        }
+        freeSymbolTable(&table);
+        freeInterner(&strings);
+    }
+    printf("%d rounds on 1..%d threads, %zu declarations of %u names: %s\n", rounds, maxThreads, wl->numDecls,
+           wl->numNames, failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
+
+static void runScaling(const Workload *wl, int maxThreads) {
+    printf("%zu declarations of %u names\n", wl->numDecls, wl->numNames);
+    printf("%8s | %10s %10s %8s | %10s %10s\n", "threads", "lock-free", "Mdecl/s", "speedup", "mutex", "Mdecl/s");
+    double base = 0;
+    for (int threads = 1; ; threads = threads * 2 > maxThreads && threads < maxThreads ? maxThreads : threads * 2) {
+        long errors = 0;
+        double lockFree = 1e30, locked = 1e30;
+        for (int rep = 0; rep < 3; rep++) {
+            double t = timeLockFree(wl, threads, 0, NULL, NULL, &errors);
+            if (t < lockFree)
+                lockFree = t;
+            t = timeLocked(wl, threads, &errors);
+            if (t < locked)
+                locked = t;
+        }
+        if (threads == 1)
+            base = lockFree;
+        printf("%8d | %8.1f ms %10.2f %7.2fx | %8.1f ms %10.2f%s\n", threads, lockFree * 1e3,
+               wl->numDecls / lockFree / 1e6, base / lockFree, locked * 1e3, wl->numDecls / locked / 1e6,
+               errors ? "  (errors)" : "");
+        if (threads >= maxThreads)
+            break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int threads = 0, rounds = 20, stress = 0;
+    long names = 200000, decls = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--names") == 0 && i + 1 < argc) {
+            names = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--declarations") == 0 && i + 1 < argc) {
+            decls = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stress") == 0) {
+            stress = 1;
+        } else {
+            printf("usage: %s [--threads N] [--names N] [--declarations N] [--rounds N] [--stress]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) {
+#ifdef _SC_NPROCESSORS_ONLN
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if (threads < 1)
+            threads = 1;
+        if (stress && threads < 4)
+            threads = 4;   // interleavings are the point, even on few CPUs
+    }
+    if (names < 1 || decls < 1) {
+        printf("--names and --declarations must be positive\n");
+        return 1;
+    }
+
+    Workload wl;
+    if (makeWorkload(&wl, (unsigned)names, (size_t)decls) != 0) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    int status = 0;
+    if (stress)
+        status = runStress(&wl, threads, rounds);
+    else
+        runScaling(&wl, threads);
+    freeWorkload(&wl);
+    return status;
+}
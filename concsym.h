@@ -0,0 +1,387 @@
+#ifndef CONCSYM_H
+#define CONCSYM_H
+
+/*
+ * Concurrent symbol table: one table that many lexer threads declare into
+ * at once.  The alternative is a table per thread with a merge afterwards
+ * (batch.h).
+ *
+ * It is open-addressed with linear probing, like the interner, but each
+ * slot is an atomic pointer to an entry.  Entries are published by CAS and
+ * stay where they are for as long as the table lives, so neither readers
+ * nor writers take locks.
+ *
+ *   - Insert.  Probe from the name's home slot until the name or an empty
+ *     slot turns up, then CAS a new entry into that empty slot.  A lost CAS
+ *     re-reads the slot, which may now hold the same name.
+ *   - First declaration wins.  Every declaration carries an order key from
+ *     the caller; batch.h uses (file << 32) + its count in the file.  An
+ *     entry's declaration record is only swapped, by CAS, for one with a
+ *     smaller key.  The result is what a sequential
+ *     run in key order would give, however the threads interleave.
+ *   - Resize.  Past 3/4 load a writer installs a table of twice the size
+ *     as the old one's successor, and from then on nothing new goes into
+ *     the old table.  Every writer that sees the successor helps move
+ *     entries, claiming chunks of old slots with a fetch-add.  An entry
+ *     moves as the same object, and its old slot is then sealed
+ *     MOVED_FULL.  An empty slot is sealed MOVED_EMPTY, which ends probe
+ *     chains in the old table.  A probe finishes the old chain and then
+ *     continues in the successor.  So while a move is under way no name
+ *     is missed or added twice, and no writer waits for another.
+ *
+ * Each thread writes through a SymbolWriter of its own.  The writer's
+ * arena holds that thread's entries, names and declaration records.  The
+ * arenas and the outgrown tables are freed with the table.
+ * concurrentSymbolsToTable turns a table that no thread is writing into an
+ * ordinary SymbolTable in key order, for printSymbolTable.  Build with
+ * -pthread.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "symtab.h"
+
+#ifndef CONCSYM_MIN_SLOTS
+#define CONCSYM_MIN_SLOTS 256        // power of two
+#endif
+#ifndef CONCSYM_MOVE_CHUNK
+#define CONCSYM_MOVE_CHUNK 256       // old slots claimed at a time while resizing
+#endif
+
+typedef struct {
+    uint64_t order;
+    const char *type;                // interned in the declaring writer's pool
+} ConcurrentDeclaration;
+
+typedef struct {
+    _Atomic(ConcurrentDeclaration *) decl;   // the winning declaration so far
+    unsigned hash, length;
+    char name[];
+} ConcurrentSymbol;
+
+// Sealed slots of a table whose entries have moved on to its successor.
+#define MOVED_EMPTY ((ConcurrentSymbol *)(uintptr_t)1)
+#define MOVED_FULL ((ConcurrentSymbol *)(uintptr_t)2)
+
+typedef struct ConcurrentSlots {
+    _Atomic(struct ConcurrentSlots *) next;  // successor, once resizing
+    struct ConcurrentSlots *older;           // predecessor, kept until the table is freed
+    atomic_uint used;                        // slots filled by inserts
+    atomic_uint moveCursor, moved;           // next slot to claim, slots moved
+    unsigned mask;
+    _Atomic(ConcurrentSymbol *) slots[];
+} ConcurrentSlots;
+
+typedef struct SymbolWriter SymbolWriter;
+
+typedef struct {
+    _Atomic(ConcurrentSlots *) current;      // newest table whose predecessors are all moved
+    _Atomic(SymbolWriter *) writers;
+} ConcurrentSymbolTable;
+
+struct SymbolWriter {
+    ConcurrentSymbolTable *table;
+    SymbolWriter *next;
+    Arena arena;                     // entries and declaration records
+    Interner types;
+};
+
+static ConcurrentSlots *newConcurrentSlots(unsigned size) {
+    ConcurrentSlots *s = calloc(1, sizeof(ConcurrentSlots) + size * sizeof(s->slots[0]));
+    if (!s)
+        return NULL;
+    s->mask = size - 1;
+    for (unsigned i = 0; i < size; i++)
+        atomic_init(&s->slots[i], NULL);
+    return s;
+}
+
+static int initConcurrentSymbolTable(ConcurrentSymbolTable *t) {
+    ConcurrentSlots *s = newConcurrentSlots(CONCSYM_MIN_SLOTS);
+    if (!s)
+        return -1;
+    atomic_init(&t->current, s);
+    atomic_init(&t->writers, NULL);
+    return 0;
+}
+
+// A writer for the calling thread; it lives as long as the table.
+static SymbolWriter *openSymbolWriter(ConcurrentSymbolTable *t) {
+    SymbolWriter *w = calloc(1, sizeof(SymbolWriter));
+    if (!w)
+        return NULL;
+    w->table = t;
+    w->next = atomic_load_explicit(&t->writers, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&t->writers, &w->next, w, memory_order_release,
+                                                  memory_order_relaxed))
+        ;
+    return w;
+}
+
+static ConcurrentDeclaration *newConcurrentDeclaration(SymbolWriter *w, uint64_t order, const char *type) {
+    ConcurrentDeclaration *d = arenaAllocAligned(&w->arena, sizeof(ConcurrentDeclaration));
+    if (!d || !(type = intern(&w->types, type)))
+        return NULL;
+    d->order = order;
+    d->type = type;
+    return d;
+}
+
+static ConcurrentSymbol *newConcurrentSymbol(SymbolWriter *w, const char *name, size_t len, unsigned hash,
+                                             ConcurrentDeclaration *decl) {
+    ConcurrentSymbol *e = arenaAllocAligned(&w->arena, sizeof(ConcurrentSymbol) + len + 1);
+    if (!e)
+        return NULL;
+    atomic_init(&e->decl, decl);
+    e->hash = hash;
+    e->length = (unsigned)len;
+    memcpy(e->name, name, len);
+    e->name[len] = '\0';
+    return e;
+}
+
+// Make decl the entry's declaration unless one with a smaller key is there.
+static void offerDeclaration(ConcurrentSymbol *e, ConcurrentDeclaration *decl) {
+    ConcurrentDeclaration *cur = atomic_load_explicit(&e->decl, memory_order_acquire);
+    while (decl->order < cur->order &&
+           !atomic_compare_exchange_weak_explicit(&e->decl, &cur, decl, memory_order_acq_rel,
+                                                  memory_order_acquire))
+        ;
+}
+
+static void moveConcurrentSlots(ConcurrentSymbolTable *t, ConcurrentSlots *s);
+
+// Install a successor of twice the size (unless another writer already
+// has) and help move s into it.
+static void growConcurrentSlots(ConcurrentSymbolTable *t, ConcurrentSlots *s) {
+    if (!atomic_load_explicit(&s->next, memory_order_acquire)) {
+        ConcurrentSlots *bigger = newConcurrentSlots((s->mask + 1) * 2), *expected = NULL;
+        if (!bigger)
+            return;
+        bigger->older = s;
+        if (!atomic_compare_exchange_strong_explicit(&s->next, &expected, bigger, memory_order_acq_rel,
+                                                     memory_order_acquire))
+            free(bigger);
+    }
+    moveConcurrentSlots(t, s);
+}
+
+/*
+ * Look for name in s alone.  Returns its entry, or NULL if the probe chain
+ * in s ended without it.  With fresh given, an empty slot at the end of
+ * the chain gets fresh (and *added is set) unless s is being resized, in
+ * which case the slot is sealed and the caller goes on to the successor.
+ */
+static ConcurrentSymbol *probeConcurrentSlots(ConcurrentSymbolTable *t, ConcurrentSlots *s, const char *name,
+                                              unsigned len, unsigned hash, ConcurrentSymbol *fresh, int *added) {
+    unsigned slot = hash & s->mask;
+    for (unsigned n = 0; n <= s->mask; n++, slot = (slot + 1) & s->mask) {
+        ConcurrentSymbol *e = atomic_load_explicit(&s->slots[slot], memory_order_acquire);
+        while (e == NULL) {
+            if (!fresh)
+                return NULL;
+            int resizing = atomic_load_explicit(&s->next, memory_order_acquire) != NULL;
+            if (atomic_compare_exchange_strong_explicit(&s->slots[slot], &e, resizing ? MOVED_EMPTY : fresh,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                if (resizing)
+                    return NULL;
+                *added = 1;
+                unsigned used = atomic_fetch_add_explicit(&s->used, 1, memory_order_relaxed) + 1;
+                if ((uint64_t)used * 4 > (uint64_t)(s->mask + 1) * 3)
+                    growConcurrentSlots(t, s);
+                return fresh;
+            }
+            // Lost the slot: e is what took it.
+        }
+        if (e == MOVED_EMPTY)
+            return NULL;
+        if (e != MOVED_FULL && e->hash == hash && e->length == len && memcmp(e->name, name, len) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+/*
+ * Find name in s and its successors; with fresh given, put fresh in if the
+ * name is not there.  Returns the entry for name, or NULL if it is not
+ * there (or fresh could not be placed for lack of memory).
+ */
+static ConcurrentSymbol *findOrPlaceSymbol(ConcurrentSymbolTable *t, ConcurrentSlots *s, const char *name,
+                                           unsigned len, unsigned hash, ConcurrentSymbol *fresh, int *added) {
+    *added = 0;
+    for (;;) {
+        if (fresh && atomic_load_explicit(&s->next, memory_order_acquire))
+            moveConcurrentSlots(t, s);
+        ConcurrentSymbol *e = probeConcurrentSlots(t, s, name, len, hash, fresh, added);
+        if (e)
+            return e;
+        ConcurrentSlots *next = atomic_load_explicit(&s->next, memory_order_acquire);
+        if (next) {
+            s = next;
+        } else if (!fresh) {
+            return NULL;
+        } else {
+            // Every slot is taken: only possible when many writers raced
+            // past the load check at once.
+            growConcurrentSlots(t, s);
+            if (!atomic_load_explicit(&s->next, memory_order_acquire))
+                return NULL;
+        }
+    }
+}
+
+// Move slot i of s to the successor and seal it.  Only the writer that
+// claimed the slot's chunk changes a slot that holds an entry.
+static void moveConcurrentSlot(ConcurrentSymbolTable *t, ConcurrentSlots *s, ConcurrentSlots *next, unsigned i) {
+    ConcurrentSymbol *e = atomic_load_explicit(&s->slots[i], memory_order_acquire);
+    while (e == NULL && !atomic_compare_exchange_weak_explicit(&s->slots[i], &e, MOVED_EMPTY,
+                                                               memory_order_acq_rel, memory_order_acquire))
+        ;
+    if (e == NULL || e == MOVED_EMPTY || e == MOVED_FULL)
+        return;
+    int added;
+    ConcurrentSymbol *placed = findOrPlaceSymbol(t, next, e->name, e->length, e->hash, e, &added);
+    if (placed && placed != e)
+        offerDeclaration(placed, atomic_load_explicit(&e->decl, memory_order_acquire));
+    atomic_store_explicit(&s->slots[i], MOVED_FULL, memory_order_release);
+}
+
+// Point t->current past every table that has been moved out completely.
+// A successor can finish moving on before its predecessor does.
+static void advanceCurrentSlots(ConcurrentSymbolTable *t) {
+    ConcurrentSlots *cur = atomic_load_explicit(&t->current, memory_order_acquire);
+    while (atomic_load_explicit(&cur->moved, memory_order_acquire) == cur->mask + 1) {
+        ConcurrentSlots *next = atomic_load_explicit(&cur->next, memory_order_acquire);
+        if (atomic_compare_exchange_strong_explicit(&t->current, &cur, next, memory_order_acq_rel,
+                                                    memory_order_acquire))
+            cur = next;
+    }
+}
+
+static void moveConcurrentSlots(ConcurrentSymbolTable *t, ConcurrentSlots *s) {
+    ConcurrentSlots *next = atomic_load_explicit(&s->next, memory_order_acquire);
+    unsigned size = s->mask + 1;
+    while (atomic_load_explicit(&s->moveCursor, memory_order_relaxed) < size) {
+        unsigned begin = atomic_fetch_add_explicit(&s->moveCursor, CONCSYM_MOVE_CHUNK, memory_order_relaxed);
+        if (begin >= size)
+            break;
+        unsigned end = size - begin < CONCSYM_MOVE_CHUNK ? size : begin + CONCSYM_MOVE_CHUNK;
+        for (unsigned i = begin; i < end; i++)
+            moveConcurrentSlot(t, s, next, i);
+        if (atomic_fetch_add_explicit(&s->moved, end - begin, memory_order_acq_rel) + (end - begin) == size)
+            advanceCurrentSlots(t);
+    }
+}
+
+/*
+ * Declare name[0..len) as type with the given order key.  Returns 1 if the
+ * name was new to the table, 0 if it was there already (the declaration
+ * with the smaller key is kept), -1 if out of memory.  Any number of
+ * threads may call this at once, each with its own writer.
+ */
+static int addConcurrentSymbol(SymbolWriter *w, const char *name, size_t len, const char *type, uint64_t order) {
+    ConcurrentSymbolTable *t = w->table;
+    unsigned hash = hashBytes(name, len);
+    int added;
+    // Most declarations repeat a name, so look before building an entry.
+    ConcurrentSlots *s = atomic_load_explicit(&t->current, memory_order_acquire);
+    ConcurrentSymbol *e = findOrPlaceSymbol(t, s, name, (unsigned)len, hash, NULL, &added);
+    if (!e || order < atomic_load_explicit(&e->decl, memory_order_acquire)->order) {
+        ConcurrentDeclaration *decl = newConcurrentDeclaration(w, order, type);
+        if (!decl)
+            return -1;
+        if (!e) {
+            ConcurrentSymbol *fresh = newConcurrentSymbol(w, name, len, hash, decl);
+            if (!fresh)
+                return -1;
+            s = atomic_load_explicit(&t->current, memory_order_acquire);
+            if (!(e = findOrPlaceSymbol(t, s, name, (unsigned)len, hash, fresh, &added)))
+                return -1;
+        }
+        if (!added)
+            offerDeclaration(e, decl);
+    }
+    LEXSTATS(lexStats.declarations++; lexStats.duplicates += !added;)
+    return added;
+}
+
+// The entry for name, or NULL.  Lock-free, and safe while writers run.
+static inline const ConcurrentSymbol *findConcurrentSymbol(ConcurrentSymbolTable *t, const char *name) {
+    int added;
+    return findOrPlaceSymbol(t, atomic_load_explicit(&t->current, memory_order_acquire), name,
+                             (unsigned)strlen(name), hashBytes(name, strlen(name)), NULL, &added);
+}
+
+static inline const char *concurrentSymbolType(const ConcurrentSymbol *e) {
+    return atomic_load_explicit(&e->decl, memory_order_acquire)->type;
+}
+
+static int concurrentOrderCompare(const void *a, const void *b) {
+    const ConcurrentSymbol *x = *(ConcurrentSymbol *const *)a, *y = *(ConcurrentSymbol *const *)b;
+    uint64_t ox = atomic_load_explicit(&x->decl, memory_order_relaxed)->order;
+    uint64_t oy = atomic_load_explicit(&y->decl, memory_order_relaxed)->order;
+    if (ox != oy)
+        return ox < oy ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+/*
+ * Copy the table into symbols (replacing what is there) in key order, so it
+ * prints like a sequential run; names and types are interned in strings.
+ * No thread may be writing.  Returns the number of symbols, or -1 if out of
+ * memory.
+ */
+static int concurrentSymbolsToTable(ConcurrentSymbolTable *t, SymbolTable *symbols, Interner *strings) {
+    ConcurrentSlots *s = atomic_load_explicit(&t->current, memory_order_acquire);
+    while (atomic_load_explicit(&s->next, memory_order_acquire))
+        s = atomic_load_explicit(&s->next, memory_order_acquire);
+    ConcurrentSymbol **all = malloc(((size_t)s->mask + 1) * sizeof(ConcurrentSymbol *));
+    if (!all)
+        return -1;
+    int count = 0;
+    for (unsigned i = 0; i <= s->mask; i++) {
+        ConcurrentSymbol *e = atomic_load_explicit(&s->slots[i], memory_order_acquire);
+        if (e && e != MOVED_EMPTY && e != MOVED_FULL)
+            all[count++] = e;
+    }
+    qsort(all, count, sizeof(ConcurrentSymbol *), concurrentOrderCompare);
+
+    resetSymbolTable(symbols);
+    for (int i = 0; i < count; i++) {
+        unsigned nameId = internString(strings, all[i]->name, all[i]->length);
+        int added;
+        int idx = nameId ? internSymbol(symbols, nameId, &added) : -1;
+        if (idx < 0) {
+            free(all);
+            return -1;
+        }
+        fillSymbolEntry(&symbols->entries[idx], nameId, internedString(strings, nameId),
+                        intern(strings, concurrentSymbolType(all[i])));
+    }
+    free(all);
+    return count;
+}
+
+static void freeConcurrentSymbolTable(ConcurrentSymbolTable *t) {
+    ConcurrentSlots *s = atomic_load_explicit(&t->current, memory_order_acquire);
+    while (s && atomic_load_explicit(&s->next, memory_order_acquire))
+        s = atomic_load_explicit(&s->next, memory_order_acquire);
+    while (s) {
+        ConcurrentSlots *older = s->older;
+        free(s);
+        s = older;
+    }
+    SymbolWriter *w = atomic_load_explicit(&t->writers, memory_order_acquire);
+    while (w) {
+        SymbolWriter *next = w->next;
+        freeArena(&w->arena);
+        freeInterner(&w->types);
+        free(w);
+        w = next;
+    }
+    memset(t, 0, sizeof(*t));
+}
+
+#endif
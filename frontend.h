@@ -0,0 +1,275 @@
+#ifndef FRONTEND_H
+#define FRONTEND_H
+
+/*
+ * Command-line driver shared by the six front ends:
+ *
+ *     [--tokens | --scopes | --binary out] [--jobs N] [--chunk-size bytes] [--cache dir] [--stream]
+ *         [path | -]
+ *     --batch [--jobs N] [--cache dir] [--shared] [--files-from list] [file | dir]...
+ *         [--includes [-I dir]...]                           (--includes: C only)
+ *     --includes [-I dir]... [--graph | --tokens] [path]     (C only)
+ *
+ * plus, in either mode, [--format text | csv | jsonl] [--output-fd N].
+ *
+ * --jobs lexes a large file on N threads (see parlex.h); it does not change
+ * the output.  --cache keeps symbol tables, and token streams when --tokens
+ * asks for them, in dir keyed by the input's content (see symcache.h).
+ * --stream reads the input in chunk-size pieces (64 KiB by default) with
+ * bounded memory (see stream.h); it is the default for stdin and other
+ * inputs that are not regular files, unless --jobs or --cache needs the
+ * whole input at once.  --scopes prints a block-scoped symbol table instead
+ * of the flat one (see scope.h); it always reads the whole input on one
+ * thread.  --binary writes the token stream to out ("-" for stdout) in the
+ * format of tokfile.h instead of printing it.  --batch is described in
+ * batch.h and --includes in incgraph.h.  --format and --output-fd choose
+ * how and where the token and symbol listings are written (see outbuf.h);
+ * text on stdout is the default.
+ * Builds with -DLEXER_STATS print lexer statistics to stderr at exit (see
+ * lexstats.h).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "batch.h"
+#include "parlex.h"
+#include "symcache.h"
+#include "stream.h"
+#include "scope.h"
+#include "tokwrite.h"
+#include "incgraph.h"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+// Lex all of src into tokens, on several threads if jobs > 1.
+static int lexAll(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, int jobs,
+                  size_t chunkSize, TokenBuffer *tokens) {
+    beginLexing(ctx, src);
+    if (jobs > 1)
+        return lexParallel(ctx, lang, src, jobs, chunkSize, tokens);
+    return lexTokens(ctx, lang, tokens, (size_t)-1) < 0 ? -1 : 0;
+}
+
+// --tokens with --cache: print the cached stream, or lex, store and print.
+static void printTokensCached(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, int jobs,
+                              size_t chunkSize, const char *cacheDir) {
+    CacheEntry entry;
+    if (openCacheEntry(&entry, cacheDir, lang, src, 1) == 0) {
+        TokenBuffer tokens = cachedTokens(&entry);
+        printTokenBuffer(src, &tokens);
+        closeCacheEntry(&entry);
+        return;
+    }
+    TokenBuffer tokens;
+    initTokenBuffer(&tokens, 1);
+    if (lexAll(ctx, lang, src, jobs, chunkSize, &tokens) != 0) {
+        freeTokenBuffer(&tokens);
+        printTokens(ctx, lang, src);
+        return;
+    }
+    lang->collectSymbols(ctx, lang, &tokens, 0, tokens.count);
+    storeCacheEntry(ctx, cacheDir, lang, src, &tokens);
+    freeSymbolTable(&ctx->symbols);
+    printTokenBuffer(src, &tokens);
+    freeTokenBuffer(&tokens);
+}
+
+// Is path something that can only be read front to back (stdin, a pipe)?
+static int isStreamPath(const char *path) {
+    if (strcmp(path, "-") == 0)
+        return 1;
+#ifndef _WIN32
+    struct stat st;
+    return stat(path, &st) == 0 && !S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode);
+#else
+    return 0;
+#endif
+}
+
+// --stream: lex path from front to back without reading it in whole.
+static int runStreaming(LexerContext *ctx, const LanguageDescriptor *lang, const char *path, int dumpTokens,
+                        size_t readSize) {
+    FILE *fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!fp) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    int status = dumpTokens ? printTokensStreaming(ctx, lang, fp, readSize)
+                            : printSymbolsStreaming(ctx, lang, fp, readSize);
+    if (fp != stdin)
+        fclose(fp);
+    freeLexerContext(ctx);
+    if (status != 0) {
+        outFlush(&output);
+        printf("Out of memory\n");
+        return 1;
+    }
+    return 0;
+}
+
+// --binary: lex all of src and write it to path in the tokfile.h format.
+static int writeTokensBinary(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, int jobs,
+                             size_t chunkSize, const char *path) {
+    TokenBuffer tokens;
+    TokenFileWriter writer;
+    initTokenBuffer(&tokens, 1);
+    int status = initTokenFileWriter(&writer, lang->name);
+    if (status == 0)
+        status = lexAll(ctx, lang, src, jobs, chunkSize, &tokens);
+    if (status == 0)
+        status = writeTokenBuffer(&writer, src, &tokens);
+    freeTokenBuffer(&tokens);
+    if (status != 0) {
+        freeTokenFileWriter(&writer);
+        printf("Out of memory\n");
+        return 1;
+    }
+    FILE *fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (!fp || finishTokenFile(&writer, fp) != 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        status = 1;
+    }
+    if (fp && fp != stdout)
+        fclose(fp);
+    freeTokenFileWriter(&writer);
+    return status;
+}
+
+// Take --format and --output-fd out of argv, wherever they are, and set up
+// output from them.  Returns 0, or -1 (after a message) for a bad value.
+static int takeOutputOptions(int *argc, char *argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < *argc) {
+            if ((output.format = outputFormat(argv[++i])) < 0) {
+                printf("Unknown format %s (text, csv or jsonl)\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--output-fd") == 0 && i + 1 < *argc) {
+            char *end;
+            long fd = strtol(argv[++i], &end, 10);
+            if (*end || fd < 0 || fd > 65535) {
+                printf("Bad file descriptor %s\n", argv[i]);
+                return -1;
+            }
+            output.fd = (int)fd;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    return 0;
+}
+
+static int runFrontEndArgs(int argc, char *argv[], const LanguageDescriptor *lang, const char *defaultPath) {
+    const char *path = defaultPath;
+    const char *cacheDir = NULL, *binaryPath = NULL;
+    int dumpTokens = 0, jobs = 1, stream = 0, scoped = 0;
+    size_t chunkSize = 0;
+    selectScanKernels();
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+        return runBatch(lang, argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--includes") == 0 && lang->directives)
+        return runIncludes(lang, argc - 2, argv + 2, defaultPath);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tokens") == 0)
+            dumpTokens = 1;
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--chunk-size") == 0 && i + 1 < argc)
+            chunkSize = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc)
+            binaryPath = argv[++i];
+        else if (strcmp(argv[i], "--scopes") == 0)
+            scoped = 1;
+        else if (strcmp(argv[i], "--stream") == 0)
+            stream = 1;
+        else
+            path = argv[i];
+    }
+
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    if (!scoped && !binaryPath && (stream || (jobs <= 1 && !cacheDir && isStreamPath(path))))
+        return runStreaming(&ctx, lang, path, dumpTokens, chunkSize);
+    if (!chunkSize)
+        chunkSize = PARLEX_MIN_CHUNK;
+
+    SourceBuffer src;
+    if (srcOpen(&src, path) != 0) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    if (binaryPath) {
+        int status = writeTokensBinary(&ctx, lang, &src, jobs, chunkSize, binaryPath);
+        freeLexerContext(&ctx);
+        srcClose(&src);
+        return status;
+    }
+    if (scoped && !dumpTokens) {
+        ScopedSymbolTable scopes;
+        generateScopedSymbolTable(&ctx, lang, &src, &scopes);
+        printScopedSymbolTable(&scopes, lang);
+        freeScopedSymbols(&scopes);
+    } else if (dumpTokens) {
+        if (cacheDir)
+            printTokensCached(&ctx, lang, &src, jobs, chunkSize, cacheDir);
+        else if (jobs > 1)
+            printTokensParallel(&ctx, lang, &src, jobs, chunkSize);
+        else
+            printTokens(&ctx, lang, &src);
+    } else {
+        int cached = 0;
+        CacheEntry entry;
+        if (cacheDir && openCacheEntry(&entry, cacheDir, lang, &src, 0) == 0) {
+            cached = loadCachedSymbols(&ctx, &entry) == 0;
+            closeCacheEntry(&entry);
+            if (!cached)
+                freeSymbolTable(&ctx.symbols);
+        }
+        if (!cached) {
+            if (jobs > 1) {
+                TokenBuffer tokens;
+                initTokenBuffer(&tokens, 0);
+                if (lexAll(&ctx, lang, &src, jobs, chunkSize, &tokens) == 0) {
+                    lang->collectSymbols(&ctx, lang, &tokens, 0, tokens.count);
+                    freeTokenBuffer(&tokens);
+                } else {
+                    // No room for the whole stream: a window at a time, on one thread.
+                    freeTokenBuffer(&tokens);
+                    generateSymbolTable(&ctx, lang, &src);
+                }
+            } else {
+                generateSymbolTable(&ctx, lang, &src);
+            }
+            if (cacheDir)
+                storeCacheEntry(&ctx, cacheDir, lang, &src, NULL);
+        }
+        printSymbolTable(&ctx, lang);
+    }
+    freeLexerContext(&ctx);
+    srcClose(&src);
+    return 0;
+}
+
+int runFrontEnd(int argc, char *argv[], const LanguageDescriptor *lang, const char *defaultPath) {
+    if (takeOutputOptions(&argc, argv) != 0)
+        return 1;
+    LEXSTATS(atexit(reportLexStats);)
+    int status = runFrontEndArgs(argc, argv, lang, defaultPath);
+    outFlush(&output);
+    if (output.failed) {
+        fprintf(stderr, "Cannot write output\n");
+        return 1;
+    }
+    return status;
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef HASHFN_H
+#define HASHFN_H
+
+/*
+ * Hash functions for names, behind one signature so they can be swapped
+ * and compared (hashstats.c measures them on a real corpus).
+ *
+ *   legacy   hash * 31 + c, the function the symbol table's Hash column
+ *            has always shown; kept for that column and for comparison
+ *   fnv1a    32-bit FNV-1a, one multiply per byte
+ *   wyhash   wyhash-style: 8 bytes per step, mixed by 64x64->128-bit
+ *            multiplies and folded to 32 bits
+ *
+ * All arithmetic is unsigned, so none of them overflow a signed int.
+ * The interner hashes with INTERN_HASH (fnv1a unless set at compile
+ * time, e.g. -DINTERN_HASH=hashWy).
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+typedef unsigned (*NameHashFn)(const char *s, size_t len);
+
+static inline unsigned hashLegacy(const char *s, size_t len) {
+    unsigned h = 0;
+    for (size_t i = 0; i < len; i++)
+        h = h * 31u + (unsigned)s[i];   // plain char, sign-extended where it is signed, as before
+    return h;
+}
+
+static inline unsigned hashFnv1a(const char *s, size_t len) {
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline uint64_t wyMix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    uint64_t lo = (mid << 32) | (uint32_t)ll;
+    uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t wyRead8(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyRead4(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline unsigned hashWy(const char *s, size_t len) {
+    static const uint64_t p0 = 0xa0761d6478bd642full, p1 = 0xe7037ed1a0b428dbull;
+    const unsigned char *p = (const unsigned char *)s;
+    uint64_t seed = p0, a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            // Two overlapping pairs of 4-byte reads cover 4..16 bytes.
+            size_t d = (len >> 3) << 2;
+            a = (wyRead4(p) << 32) | wyRead4(p + d);
+            b = (wyRead4(p + len - 4) << 32) | wyRead4(p + len - 4 - d);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        for (; i > 16; i -= 16, p += 16)
+            seed = wyMix(wyRead8(p) ^ p1, wyRead8(p + 8) ^ seed);
+        a = wyRead8(p + i - 16);
+        b = wyRead8(p + i - 8);
+    }
+    uint64_t h = wyMix(p1 ^ len, wyMix(a ^ p1, b ^ seed));
+    return (unsigned)(h ^ (h >> 32));
+}
+
+typedef struct {
+    const char *name;
+    NameHashFn fn;
+} NameHash;
+
+static const NameHash nameHashes[] = {
+    { "legacy", hashLegacy },
+    { "fnv1a", hashFnv1a },
+    { "wyhash", hashWy },
+};
+
+#define NUM_NAME_HASHES (sizeof(nameHashes) / sizeof(nameHashes[0]))
+
+// The hash function called name, or NULL.
+static inline const NameHash *findNameHash(const char *name) {
+    for (size_t i = 0; i < NUM_NAME_HASHES; i++) {
+        if (strcmp(nameHashes[i].name, name) == 0)
+            return &nameHashes[i];
+    }
+    return NULL;
+}
+
+#ifndef INTERN_HASH
+#define INTERN_HASH hashFnv1a
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+// Hash function analytics: how evenly each name hash in hashfn.h (legacy,
+// FNV-1a, wyhash-style) spreads the names of a real corpus, so the one the
+// interner uses can be picked from data.
+//
+//     gcc -O2 -pthread hashstats.c -o hashstats
+//     ./hashstats [--lang name] [--buckets N] [--synthetic N] [files...]
+//     ./hashstats --check
+//
+// The names are the distinct identifiers, keywords and variables the
+// lexer finds in the files (language from each file's extension unless
+// --lang is given); --synthetic adds N generated names in the v0, v1, ...
+// pattern generated code is full of.  For each function this reports:
+//
+//   - the spread over --buckets buckets (default SYMBOL_HASH_BUCKETS, as in
+//     the Hash column): empty buckets, the fullest one, and chi-square per
+//     degree of freedom against a uniform spread (about 1 for a good hash)
+//   - a chained table with a power-of-two bucket count of at least one per
+//     name: the longest chain and the mean chain walk of a lookup
+//   - the interner's table (linear probing, power-of-two size, grown past
+//     3/4 load): the achieved load factor and the mean and longest probe
+//   - ns per hash over all the names
+//
+// --check tests the interner instead: names that differ only after an
+// embedded NUL byte, or only by a trailing one, must get distinct ids and
+// come back intact, even when their hashes collide (a pair that does is
+// searched for).  It prints the failures and exits 1 if there are any.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "languages.h"
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const LanguageDescriptor *pickLanguage(const char *path, const char *name) {
+    static const struct { const char *name, *ext; const LanguageDescriptor *lang; } table[] = {
+        { "javascript", ".js", &javascriptLanguage }, { "c", ".c", &cLanguage },
+        { "java", ".java", &javaLanguage }, { "csharp", ".cs", &csharpLanguage },
+        { "ruby", ".rb", &rubyLanguage }, { "perl", ".pl", &perlLanguage },
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (name ? strcmp(name, table[i].name) == 0 : hasExtension(path, table[i].ext))
+            return table[i].lang;
+    }
+    return name ? NULL : &javascriptLanguage;
+}
+
+// Add the names in one file to the pool.  Returns 0, or -1 if it cannot be read.
+static int collectNames(Interner *names, const LanguageDescriptor *lang, const char *path) {
+    SourceBuffer src;
+    LexerContext ctx;
+    if (srcOpen(&src, path) != 0)
+        return -1;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, &src);
+    for (;;) {
+        Token t = getNextToken(&ctx, lang);
+        if (t.kind == TOKEN_EOF)
+            break;
+        if (t.kind == TOKEN_ID || t.kind == TOKEN_KEYWORD || t.kind == TOKEN_VARIABLE)
+            internString(names, src.data + t.offset, (size_t)t.length);
+    }
+    srcClose(&src);
+    return 0;
+}
+
+typedef struct {
+    unsigned empty, fullest;
+    double chiSquare;            // per degree of freedom
+    unsigned maxChain;
+    double meanChain;
+    double load, meanProbe;
+    unsigned maxProbe;
+    double nsPerHash;
+} HashReport;
+
+// The Hash column's fold: abs(hash % buckets) of the hash taken as an int.
+static unsigned foldBucket(unsigned h, unsigned buckets) {
+    return h <= INT_MAX ? h % buckets : (0u - h) % buckets;
+}
+
+static void measureSpread(HashReport *r, const unsigned *hashes, size_t n, unsigned buckets) {
+    unsigned *counts = calloc(buckets, sizeof(unsigned));
+    for (size_t i = 0; i < n; i++)
+        counts[foldBucket(hashes[i], buckets)]++;
+    double expected = (double)n / buckets, chi = 0;
+    for (unsigned b = 0; b < buckets; b++) {
+        r->empty += counts[b] == 0;
+        if (counts[b] > r->fullest)
+            r->fullest = counts[b];
+        chi += (counts[b] - expected) * (counts[b] - expected) / expected;
+    }
+    r->chiSquare = buckets > 1 ? chi / (buckets - 1) : 0;
+    free(counts);
+}
+
+static void measureChains(HashReport *r, const unsigned *hashes, size_t n) {
+    size_t size = 1;
+    while (size < n)
+        size *= 2;
+    unsigned *chains = calloc(size, sizeof(unsigned));
+    for (size_t i = 0; i < n; i++)
+        chains[hashes[i] & (size - 1)]++;
+    double walk = 0;
+    for (size_t b = 0; b < size; b++) {
+        if (chains[b] > r->maxChain)
+            r->maxChain = chains[b];
+        walk += (double)chains[b] * (chains[b] + 1) / 2;   // finding each entry of the chain
+    }
+    r->meanChain = n ? walk / n : 0;
+    free(chains);
+}
+
+// Insert every name the way internString does and measure the probes.
+static void measureProbes(HashReport *r, const unsigned *hashes, size_t n) {
+    size_t size = 256;
+    while ((n + 1) * 4 > size * 3)
+        size *= 2;
+    unsigned char *used = calloc(size, 1);
+    double probes = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t slot = hashes[i] & (size - 1);
+        unsigned p = 0;
+        while (used[slot]) {
+            slot = (slot + 1) & (size - 1);
+            p++;
+        }
+        used[slot] = 1;
+        probes += p;
+        if (p > r->maxProbe)
+            r->maxProbe = p;
+    }
+    r->load = (double)n / size;
+    r->meanProbe = n ? probes / n : 0;
+    free(used);
+}
+
+static double timeHash(NameHashFn fn, const Interner *names) {
+    size_t n = names->count - 1, hashed = 0;
+    volatile unsigned sink = 0;
+    double start = nowSeconds(), elapsed;
+    do {
+        for (unsigned id = 1; id < names->count; id++)
+            sink ^= fn(names->strings[id], names->lengths[id]);
+        hashed += n;
+    } while ((elapsed = nowSeconds() - start) < 0.05);
+    (void)sink;
+    return elapsed * 1e9 / hashed;
+}
+
+#define NUL_KEY_LEN 12
+
+// "nul", a NUL, then eight bytes scrambled from k.
+static void nulKey(char *key, unsigned k) {
+    uint64_t x = (k + 1) * 0x9e3779b97f4a7c15ull;
+    x ^= x >> 31;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 29;
+    memcpy(key, "nul", 4);
+    memcpy(key + 4, &x, 8);
+}
+
+// Two keys from nulKey with the same interner hash: equal as C strings, so
+// only a comparison of all their bytes tells them apart.  0 if none found.
+static int findNulCollision(unsigned *a, unsigned *b) {
+    enum { TRIES = 1 << 20, SIZE = 1 << 21 };
+    unsigned *slots = calloc(SIZE, sizeof(unsigned));   // k + 1 by hash
+    int found = 0;
+    for (unsigned k = 0; slots && k < TRIES && !found; k++) {
+        char key[NUL_KEY_LEN];
+        nulKey(key, k);
+        unsigned h = hashBytes(key, NUL_KEY_LEN), s = h & (SIZE - 1);
+        for (; slots[s]; s = (s + 1) & (SIZE - 1)) {
+            char other[NUL_KEY_LEN];
+            nulKey(other, slots[s] - 1);
+            if (hashBytes(other, NUL_KEY_LEN) == h) {
+                *a = slots[s] - 1;
+                *b = k;
+                found = 1;
+                break;
+            }
+        }
+        slots[s] = k + 1;
+    }
+    free(slots);
+    return found;
+}
+
+static int checkInterner(void) {
+    static const struct { const char *s; size_t len; } fixed[] = {
+        { "ab\0x", 4 }, { "ab\0y", 4 }, { "ab", 2 }, { "ab\0", 3 }, { "\0", 1 }, { "\0\0", 2 },
+        { "a\0b\0c", 5 }, { "a", 1 },
+    };
+    enum { NUM_FIXED = sizeof(fixed) / sizeof(fixed[0]), NUM_KEYS = NUM_FIXED + 2 + 20000 };
+    static char generated[NUM_KEYS][16];
+    unsigned collision[2];
+    if (!findNulCollision(&collision[0], &collision[1])) {
+        printf("no colliding pair of keys found\n");
+        return 1;
+    }
+    const char *keys[NUM_KEYS];
+    size_t lengths[NUM_KEYS];
+    unsigned ids[NUM_KEYS];
+    Interner in = { 0 };
+    int failures = 0;
+
+    // The generated keys share a prefix before a NUL and differ after it,
+    // and enough of them grow the table several times.
+    for (int k = 0; k < NUM_KEYS; k++) {
+        if (k < NUM_FIXED) {
+            keys[k] = fixed[k].s;
+            lengths[k] = fixed[k].len;
+        } else if (k < NUM_FIXED + 2) {
+            nulKey(generated[k], collision[k - NUM_FIXED]);
+            keys[k] = generated[k];
+            lengths[k] = NUL_KEY_LEN;
+        } else {
+            int n = snprintf(generated[k], sizeof(generated[k]), "id?%d", k);
+            generated[k][2] = '\0';
+            keys[k] = generated[k];
+            lengths[k] = (size_t)n;
+        }
+        ids[k] = internString(&in, keys[k], lengths[k]);
+    }
+    for (int k = 0; k < NUM_KEYS; k++) {
+        unsigned id = ids[k];
+        if (!id || internString(&in, keys[k], lengths[k]) != id || findInterned(&in, keys[k], lengths[k]) != id ||
+            in.lengths[id] != lengths[k] || memcmp(internedString(&in, id), keys[k], lengths[k]) != 0) {
+            printf("key %d (length %zu): wrong id or contents\n", k, lengths[k]);
+            failures++;
+        }
+    }
+    if (in.count != NUM_KEYS + 1) {
+        printf("%d keys interned as %u distinct names\n", NUM_KEYS, in.count - 1);
+        failures++;
+    }
+    printf("interner check, %d keys with embedded NULs: %s\n", NUM_KEYS, failures ? "FAILED" : "ok");
+    freeInterner(&in);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *langName = NULL;
+    unsigned buckets = SYMBOL_HASH_BUCKETS;
+    long synthetic = 0;
+    int files = 0;
+    Interner names = { 0 };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lang") == 0 && i + 1 < argc) {
+            langName = argv[++i];
+            if (!pickLanguage(NULL, langName)) {
+                fprintf(stderr, "Unknown language %s\n", langName);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--buckets") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            buckets = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--synthetic") == 0 && i + 1 < argc) {
+            synthetic = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0) {
+            return checkInterner();
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            printf("usage: %s [--lang name] [--buckets N] [--synthetic N] [files...] | --check\n", argv[0]);
+            return 1;
+        } else if (collectNames(&names, pickLanguage(argv[i], langName), argv[i]) != 0) {
+            fprintf(stderr, "Cannot read %s\n", argv[i]);
+        } else {
+            files++;
+        }
+    }
+    for (long k = 0; k < synthetic; k++) {
+        char name[32];
+        int len = snprintf(name, sizeof(name), "v%ld", k);
+        internString(&names, name, (size_t)len);
+    }
+    size_t n = names.count ? names.count - 1 : 0;
+    if (n == 0) {
+        printf("No names to hash; give source files or --synthetic N\n");
+        return 1;
+    }
+
+    double meanLength = 0;
+    for (unsigned id = 1; id < names.count; id++)
+        meanLength += names.lengths[id];
+    printf("%zu distinct names from %d files (%ld synthetic), mean length %.1f\n", n, files, synthetic,
+           meanLength / n);
+    printf("%-8s | %-27s | %-16s | %-26s | %s\n", "", "spread over buckets", "chained table",
+           "interner table", "");
+    printf("%-8s | %7s %8s %10s | %7s %8s | %6s %10s %8s | %s\n", "hash", "empty", "fullest", "chi2/df",
+           "longest", "mean", "load", "mean probe", "longest", "ns/hash");
+
+    unsigned *hashes = malloc(n * sizeof(unsigned));
+    for (size_t f = 0; f < NUM_NAME_HASHES; f++) {
+        HashReport r = { 0 };
+        for (unsigned id = 1; id < names.count; id++)
+            hashes[id - 1] = nameHashes[f].fn(names.strings[id], names.lengths[id]);
+        measureSpread(&r, hashes, n, buckets);
+        measureChains(&r, hashes, n);
+        measureProbes(&r, hashes, n);
+        r.nsPerHash = timeHash(nameHashes[f].fn, &names);
+        printf("%-8s | %7u %8u %10.3f | %7u %8.3f | %6.3f %10.3f %8u | %.2f\n", nameHashes[f].name, r.empty,
+               r.fullest, r.chiSquare, r.maxChain, r.meanChain, r.load, r.meanProbe, r.maxProbe, r.nsPerHash);
+    }
+    free(hashes);
+    freeInterner(&names);
+    return 0;
+}
@@ -0,0 +1,339 @@
+// Benchmark for the header cache shared by translation units
+// (incgraph.h), over a synthetic C project with deep include fan-out.
+//
+//     gcc -O2 -pthread incbench.c -o incbench
+//     ./incbench [--units N] [--depth N] [--width N] [--fanout N] [--decls N]
+//                [--touch N] [--jobs N] [--dir path]
+//
+// The project has --depth layers (8 by default) of --width headers (64).
+// Each header has an include guard and --decls declarations (40), and
+// includes --fanout (4) pseudo-randomly picked headers of the next layer,
+// so a header near the top reaches most of the ones below it.  Each of
+// --units (200) .c files includes --fanout headers of the top layer.
+//
+// The units are scanned as --batch --includes would, on --jobs threads
+// (the number of CPUs by default), in these passes:
+//
+//     per-unit   a fresh cache for each unit, so every unit lexes every
+//                header it reaches, as one process per unit would
+//     shared     one cache for all units, starting empty: each header is
+//                lexed once
+//     warm       the same cache in a new run: each header is stat'ed once
+//                and reused, nothing is lexed
+//     touched    after --touch (10) headers have been edited: only those
+//                are lexed again (stale)
+//     fresh      a new cache over the edited project, for comparison
+//
+// Each line gives the time, the files lexed (units and headers), the bytes
+// lexed, and the cache's hits and misses.  Every pass must give every unit
+// the same table as the per-unit pass does (the touched one as a fresh
+// cache does after the edits); a mismatch is reported and the exit status
+// is 1.  The project goes in a temporary directory that is removed
+// afterwards, or in --dir, which is kept.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "languages.h"
+
+typedef struct {
+    char *dir, *includeDir;
+    int units, depth, width, fanout, decls;
+} Project;
+
+typedef struct {
+    const Project *project;
+    HeaderCache *shared;        // NULL: a cache per unit
+    atomic_int next;            // next unit to scan
+    uint64_t *digests;          // by unit
+    // Totals of the per-unit caches.
+    atomic_int lexedFiles, hits, misses, stale, failed;
+    atomic_llong lexedBytes;
+} Pass;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+static void headerPath(const Project *p, int layer, int i, char *path, size_t size) {
+    snprintf(path, size, "%s/L%d_%d.h", p->includeDir, layer, i);
+}
+
+static void unitPath(const Project *p, int unit, char *path, size_t size) {
+    snprintf(path, size, "%s/u%d.c", p->dir, unit);
+}
+
+// Header i of layer, plus `extra` more declarations (for --touch).
+static int writeHeader(const Project *p, int layer, int i, int extra) {
+    char path[4096];
+    headerPath(p, layer, i, path, sizeof(path));
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return -1;
+    fprintf(fp, "#ifndef L%d_%d_H\n#define L%d_%d_H\n\n", layer, i, layer, i);
+    for (int f = 0; layer + 1 < p->depth && f < p->fanout; f++) {
+        uint64_t pick = mix64(((uint64_t)layer << 40) + ((uint64_t)i << 20) + f) % p->width;
+        fprintf(fp, "#include \"L%d_%d.h\"\n", layer + 1, (int)pick);
+    }
+    fprintf(fp, "\n");
+    for (int k = 0; k < p->decls + extra; k++) {
+        switch (k % 4) {
+        case 0: fprintf(fp, "int count_%d_%d_%d;\n", layer, i, k); break;
+        case 1: fprintf(fp, "float scale_%d_%d_%d(void);\n", layer, i, k); break;
+        case 2: fprintf(fp, "#define LIMIT_%d_%d_%d %d\n", layer, i, k, k * 16); break;
+        default: fprintf(fp, "/* helper %d */\nchar *name_%d_%d_%d(int n) { return 0; }\n", k, layer, i, k); break;
+        }
+    }
+    fprintf(fp, "\n#endif\n");
+    return fclose(fp);
+}
+
+static int writeProject(const Project *p) {
+    mkdir(p->dir, 0777);
+    mkdir(p->includeDir, 0777);
+    for (int layer = 0; layer < p->depth; layer++) {
+        for (int i = 0; i < p->width; i++) {
+            if (writeHeader(p, layer, i, 0) != 0)
+                return -1;
+        }
+    }
+    for (int u = 0; u < p->units; u++) {
+        char path[4096];
+        unitPath(p, u, path, sizeof(path));
+        FILE *fp = fopen(path, "w");
+        if (!fp)
+            return -1;
+        for (int f = 0; f < p->fanout; f++)
+            fprintf(fp, "#include <L0_%d.h>\n", (int)(mix64(((uint64_t)u << 20) + f + 0x9e37) % p->width));
+        fprintf(fp, "\nint unit_%d;\nvoid run_%d(void) { count_0_0_0 = %d; }\n", u, u, u);
+        if (fclose(fp) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void removeProject(const Project *p) {
+    char path[4096];
+    for (int layer = 0; layer < p->depth; layer++) {
+        for (int i = 0; i < p->width; i++) {
+            headerPath(p, layer, i, path, sizeof(path));
+            remove(path);
+        }
+    }
+    for (int u = 0; u < p->units; u++) {
+        unitPath(p, u, path, sizeof(path));
+        remove(path);
+    }
+    rmdir(p->includeDir);
+    rmdir(p->dir);
+}
+
+// Names and types of a unit's table, in order.
+static uint64_t tableDigest(const SymbolTable *table) {
+    uint64_t h = (uint64_t)table->count;
+    for (int i = 0; i < table->count; i++) {
+        const SymbolTableEntry *e = &table->entries[i];
+        h = mix64(h ^ hashBytes(e->name, strlen(e->name)) ^ ((uint64_t)hashBytes(e->type, strlen(e->type)) << 32));
+    }
+    return h;
+}
+
+static void *passWorker(void *arg) {
+    Pass *pass = arg;
+    const Project *p = pass->project;
+    LexerContext ctx;
+    IncludeWalker walker;
+    initLexerContext(&ctx);
+    initIncludeWalker(&walker, pass->shared, &ctx);
+    for (int u; (u = atomic_fetch_add(&pass->next, 1)) < p->units; ) {
+        HeaderCache own;
+        if (!pass->shared) {
+            if (initHeaderCache(&own, &cLanguage) != 0 || addIncludeDir(&own, p->includeDir) != 0) {
+                atomic_fetch_add(&pass->failed, 1);
+                continue;
+            }
+            walker.cache = &own;
+        }
+        char path[4096];
+        unitPath(p, u, path, sizeof(path));
+        if (scanTranslationUnit(&walker, path) != 0)
+            atomic_fetch_add(&pass->failed, 1);
+        else
+            pass->digests[u] = tableDigest(&ctx.symbols);
+        resetSymbolTable(&ctx.symbols);
+        if (!pass->shared) {
+            atomic_fetch_add(&pass->lexedFiles, atomic_load(&own.lexedFiles));
+            atomic_fetch_add(&pass->lexedBytes, atomic_load(&own.lexedBytes));
+            atomic_fetch_add(&pass->hits, atomic_load(&own.hits));
+            atomic_fetch_add(&pass->misses, atomic_load(&own.misses));
+            atomic_fetch_add(&pass->stale, atomic_load(&own.stale));
+            freeHeaderCache(&own);
+        }
+    }
+    freeIncludeWalker(&walker);
+    freeLexerContext(&ctx);
+    return NULL;
+}
+
+// Scan every unit on jobs threads, with the shared cache or a cache per
+// unit, and print a line for the pass.
+static int runPass(const char *label, const Project *p, HeaderCache *shared, int jobs, uint64_t *digests) {
+    Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.project = p;
+    pass.shared = shared;
+    pass.digests = digests;
+    int lexedFiles = 0, hits = 0, misses = 0, stale = 0;
+    long long lexedBytes = 0;
+    if (shared) {
+        beginHeaderRun(shared);
+        lexedFiles = -atomic_load(&shared->lexedFiles);
+        lexedBytes = -atomic_load(&shared->lexedBytes);
+        hits = -atomic_load(&shared->hits);
+        misses = -atomic_load(&shared->misses);
+        stale = -atomic_load(&shared->stale);
+    }
+
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    double start = nowSeconds();
+    int started = 0;
+    for (int t = 1; threads && t < jobs; t++)
+        started += pthread_create(&threads[started], NULL, passWorker, &pass) == 0;
+    passWorker(&pass);
+    for (int t = 0; t < started; t++)
+        pthread_join(threads[t], NULL);
+    double seconds = nowSeconds() - start;
+    free(threads);
+
+    HeaderCache *c = shared;
+    lexedFiles += c ? atomic_load(&c->lexedFiles) : atomic_load(&pass.lexedFiles);
+    lexedBytes += c ? atomic_load(&c->lexedBytes) : atomic_load(&pass.lexedBytes);
+    hits += c ? atomic_load(&c->hits) : atomic_load(&pass.hits);
+    misses += c ? atomic_load(&c->misses) : atomic_load(&pass.misses);
+    stale += c ? atomic_load(&c->stale) : atomic_load(&pass.stale);
+    printf("%-10s | %9.1f ms %9.1f units/s | %8d %9.1f MB | %9d %8d %6d\n", label, seconds * 1e3,
+           p->units / seconds, lexedFiles, lexedBytes / 1e6, hits, misses, stale);
+    return atomic_load(&pass.failed);
+}
+
+static int sameDigests(const char *label, const uint64_t *a, const uint64_t *b, int units) {
+    for (int u = 0; u < units; u++) {
+        if (a[u] != b[u]) {
+            printf("%s: the table of u%d.c differs\n", label, u);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    Project p = { NULL, NULL, 200, 8, 64, 4, 40 };
+    int jobs = defaultJobs(), touch = 10;
+    const char *dir = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--units") == 0 && i + 1 < argc) {
+            p.units = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            p.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            p.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fanout") == 0 && i + 1 < argc) {
+            p.fanout = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--decls") == 0 && i + 1 < argc) {
+            p.decls = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--touch") == 0 && i + 1 < argc) {
+            touch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            printf("usage: %s [--units N] [--depth N] [--width N] [--fanout N] [--decls N]\n"
+                   "       [--touch N] [--jobs N] [--dir path]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (p.units < 1 || p.depth < 1 || p.width < 1 || p.fanout < 1 || p.decls < 0) {
+        printf("--units, --depth, --width and --fanout must be positive\n");
+        return 1;
+    }
+    if (jobs < 1)
+        jobs = 1;
+    if (touch > p.depth * p.width)
+        touch = p.depth * p.width;
+
+    char temp[] = "/tmp/incbenchXXXXXX";
+    if (!dir && !(dir = mkdtemp(temp))) {
+        printf("Cannot create a temporary directory\n");
+        return 1;
+    }
+    p.dir = strdup(dir);
+    p.includeDir = malloc(strlen(dir) + 16);
+    uint64_t *expected = calloc(p.units, sizeof(uint64_t)), *digests = calloc(p.units, sizeof(uint64_t));
+    if (!p.dir || !p.includeDir || !expected || !digests) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    sprintf(p.includeDir, "%s/include", dir);
+    if (writeProject(&p) != 0) {
+        printf("Cannot write the project in %s\n", dir);
+        return 1;
+    }
+
+    printf("%d units, %d layers of %d headers, fan-out %d, %d declarations each, %d threads\n", p.units, p.depth,
+           p.width, p.fanout, p.decls, jobs);
+    printf("%-10s | %12s %17s | %8s %12s | %9s %8s %6s\n", "pass", "time", "throughput", "lexed", "", "hits",
+           "misses", "stale");
+
+    HeaderCache cache, fresh;
+    initHeaderCache(&cache, &cLanguage);
+    addIncludeDir(&cache, p.includeDir);
+    int failed = runPass("per-unit", &p, NULL, jobs, expected), ok = 1;
+    failed += runPass("shared", &p, &cache, jobs, digests);
+    ok &= sameDigests("shared", expected, digests, p.units);
+    failed += runPass("warm", &p, &cache, jobs, digests);
+    ok &= sameDigests("warm", expected, digests, p.units);
+
+    // Edit --touch headers spread over the layers; each gets longer, so its
+    // stamp changes even within the same second.
+    for (int k = 0; k < touch; k++) {
+        int h = (int)((long long)k * p.depth * p.width / touch);
+        writeHeader(&p, h / p.width, h % p.width, 1);
+    }
+    failed += runPass("touched", &p, &cache, jobs, digests);
+    initHeaderCache(&fresh, &cLanguage);
+    addIncludeDir(&fresh, p.includeDir);
+    failed += runPass("fresh", &p, &fresh, jobs, expected);
+    ok &= sameDigests("touched", expected, digests, p.units);
+    freeHeaderCache(&fresh);
+    freeHeaderCache(&cache);
+
+    if (failed)
+        printf("%d units could not be scanned\n", failed);
+    printf("%s\n", ok && !failed ? "tables agree" : "MISMATCH");
+    if (dir == temp)
+        removeProject(&p);
+    else
+        printf("project kept in %s\n", dir);
+    free(p.dir);
+    free(p.includeDir);
+    free(expected);
+    free(digests);
+    return ok && !failed ? 0 : 1;
+}
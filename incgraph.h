@@ -0,0 +1,722 @@
+#ifndef INCGRAPH_H
+#define INCGRAPH_H
+
+/*
+ * C preprocessor directives, the include graph (--includes) and the
+ * header cache shared by the translation units of a batch.
+ *
+ *     csample --includes [-I dir]... [--graph | --tokens] [path]
+ *     csample --batch --includes [-I dir]... [file | dir]...
+ *
+ * The C lexer returns each preprocessor line as one TOKEN_DIRECTIVE
+ * (lexer.h); parseDirective picks out the two that matter here:
+ * #include, with its path, and #define, with the name it defines (the C
+ * collector records that as a "macro").
+ *
+ * --includes builds the symbol table of a translation unit rather than of
+ * one file.  The declarations of a header count where it is included, as
+ * if its text were pasted there.  Each header is expanded once per
+ * translation unit, the first time it is reached, as include guards or
+ * #pragma once would have it.  "file.h" is looked for next to the file
+ * that includes it and then in the -I directories, <file.h> only in the
+ * -I directories.  Includes that are not found, including the system
+ * headers unless their directory is given, are counted and skipped.
+ * Nothing is evaluated: #if and #ifdef blocks all count, and macros are
+ * not expanded.  --graph prints the include tree instead of the symbols:
+ * one line per file, indented by a '.' per level as in gcc -H.  --tokens
+ * prints the unit's token stream with each #include that expands replaced
+ * by the tokens of its header (rows and columns are within each file).
+ *
+ * Headers live in a HeaderCache, keyed by their canonical path (realpath)
+ * so one reached by different spellings is one file.  A header is lexed
+ * once and kept as a version: its token stream, with positions, and its
+ * items, the declarations and includes in source order with the includes
+ * already resolved.  Expanding it is then a walk over those items.  The
+ * cache serves every translation unit of a run, on any number of threads:
+ * with --batch --includes each header is lexed once for the whole batch,
+ * not once per unit that includes it.  Each worker walks units with an
+ * IncludeWalker of its own, which holds what is per unit (which headers
+ * this walk has reached, and the lexer context the symbols go to).  The
+ * units themselves are lexed, walked and dropped.
+ *
+ * A version is stamped with the file's mtime and size.  The first time a
+ * run (a generation, see beginHeaderRun) reaches a header, the file is
+ * stat'ed: a matching stamp is a hit and the version is reused, anything
+ * else a miss, and the header is lexed again (counted as stale if it had
+ * a version before).  Later uses in the same generation are hits that do
+ * not touch the file system.  A batch run, a single --includes run and
+ * each incbench pass is one generation.  The mtime has the resolution of st_mtime,
+ * seconds on most systems, so an edit that keeps the size within the same
+ * second goes unnoticed until the next one.  Superseded versions stay in
+ * memory until the cache is freed, so a walk that still holds one is safe.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "lexer.h"
+#include "tokbuf.h"
+
+#ifndef INCLUDE_MAX_DEPTH
+#define INCLUDE_MAX_DEPTH 200   // nesting limit, as in cpp
+#endif
+
+/* -------------------------------------------------------------- directives */
+
+enum { DIRECTIVE_OTHER, DIRECTIVE_INCLUDE, DIRECTIVE_DEFINE };
+
+typedef struct {
+    const char *arg;   // #include: the path between the delimiters; #define: the name
+    size_t argLen;
+    int angled;        // #include <...> rather than "..."
+} Directive;
+
+static inline int isIdentByte(unsigned char c) {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+static size_t skipBlanks(const char *text, size_t i, size_t len) {
+    while (i < len && (text[i] == ' ' || text[i] == '\t'))
+        i++;
+    return i;
+}
+
+// Classify the directive token text[0, len) and find its argument.
+static int parseDirective(const char *text, size_t len, Directive *d) {
+    size_t i = skipBlanks(text, 1, len), word = i;
+    while (i < len && isIdentByte((unsigned char)text[i]))
+        i++;
+    size_t wordLen = i - word;
+    i = skipBlanks(text, i, len);
+    memset(d, 0, sizeof(*d));
+
+    if (wordLen == 6 && memcmp(text + word, "define", 6) == 0) {
+        size_t name = i;
+        while (i < len && isIdentByte((unsigned char)text[i]))
+            i++;
+        if (i == name || (text[name] >= '0' && text[name] <= '9'))
+            return DIRECTIVE_OTHER;
+        d->arg = text + name;
+        d->argLen = i - name;
+        return DIRECTIVE_DEFINE;
+    }
+    if (wordLen == 7 && memcmp(text + word, "include", 7) == 0 && i < len &&
+        (text[i] == '"' || text[i] == '<')) {
+        const char *close = memchr(text + i + 1, text[i] == '"' ? '"' : '>', len - i - 1);
+        if (!close || close == text + i + 1)
+            return DIRECTIVE_OTHER;
+        d->arg = text + i + 1;
+        d->argLen = (size_t)(close - d->arg);
+        d->angled = text[i] == '<';
+        return DIRECTIVE_INCLUDE;
+    }
+    return DIRECTIVE_OTHER;   // computed includes (#include MACRO) among them
+}
+
+/* ------------------------------------------------------------ header cache */
+
+typedef struct HeaderFile HeaderFile;
+
+typedef struct {
+    const char *name;    // a declaration's name; NULL for an include
+    unsigned nameLen;
+    const char *text;    // a declaration's type; an include's path as written
+    HeaderFile *header;  // an include's file, or NULL if it was not found
+    size_t token;        // an include's directive token
+} IncludeItem;
+
+// A file's items while it is lexed (strings in the lexing context's pool).
+typedef struct {
+    IncludeItem *items;
+    size_t count, capacity;
+    int failed;
+} IncludeItems;
+
+// A header as it was lexed.  Everything but src is in the cache's arena.
+typedef struct HeaderVersion {
+    long long mtime, size;       // stamp of the file when it was lexed
+    SourceBuffer src;            // kept open: token lexemes point into it
+    TokenBuffer tokens;          // with positions
+    IncludeItem *items;          // strings in the cache's pool
+    size_t numItems;
+    struct HeaderVersion *next;  // every version the cache has made
+} HeaderVersion;
+
+struct HeaderFile {
+    char *path;                  // canonical
+    unsigned hash;               // hashBytes(path)
+    int id;                      // index in HeaderCache.files
+    HeaderVersion *version;      // NULL until read, or if it cannot be
+    atomic_int checked;          // last generation the version was checked in
+    int busy;                    // a thread is checking or lexing it
+};
+
+typedef struct {
+    const LanguageDescriptor *lang;
+    pthread_mutex_t lock;        // the tables below and the slow path of headerVersion
+    pthread_cond_t idle;         // some busy file is done
+    HeaderFile **files;
+    int count, capacity;
+    int *slots;                  // file id + 1 by path hash, 0 if empty
+    unsigned mask;
+    const char **dirs;           // -I directories, in order
+    int numDirs;
+    int generation;
+    Arena arena;                 // versions' tokens and items
+    Interner strings;            // items' names and types
+    HeaderVersion *versions;
+    // Counters for the summary: header uses served from the cache and
+    // lexed, misses of a file that had a version, and files (headers or
+    // units) lexed.
+    atomic_int hits, misses, stale, lexedFiles;
+    atomic_llong lexedBytes;
+} HeaderCache;
+
+static int initHeaderCache(HeaderCache *c, const LanguageDescriptor *lang) {
+    memset(c, 0, sizeof(*c));
+    c->lang = lang;
+    c->generation = 1;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->idle, NULL);
+    if (!(c->slots = calloc(256, sizeof(int))))
+        return -1;
+    c->mask = 255;
+    return 0;
+}
+
+static void freeHeaderCache(HeaderCache *c) {
+    for (HeaderVersion *v = c->versions; v; v = v->next)
+        srcClose(&v->src);
+    for (int i = 0; i < c->count; i++) {
+        free(c->files[i]->path);
+        free(c->files[i]);
+    }
+    free(c->files);
+    free(c->slots);
+    free(c->dirs);
+    freeArena(&c->arena);
+    freeInterner(&c->strings);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->idle);
+    memset(c, 0, sizeof(*c));
+}
+
+static int addIncludeDir(HeaderCache *c, const char *dir) {
+    const char **dirs = realloc(c->dirs, (c->numDirs + 1) * sizeof(char *));
+    if (!dirs)
+        return -1;
+    c->dirs = dirs;
+    c->dirs[c->numDirs++] = dir;
+    return 0;
+}
+
+// Start a new run over the cache: each header's stamp is checked again the
+// next time it is used.  No walk may be under way.
+static void beginHeaderRun(HeaderCache *c) {
+    c->generation++;
+}
+
+// Canonical name of the regular file at path (malloc'd), or NULL if there
+// is none.
+static char *canonicalPath(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        return NULL;
+#ifndef _WIN32
+    return realpath(path, NULL);
+#else
+    return _fullpath(NULL, path, 0);
+#endif
+}
+
+static int growHeaderSlots(HeaderCache *c) {
+    unsigned size = (c->mask + 1) * 2;
+    int *slots = calloc(size, sizeof(int));
+    if (!slots)
+        return -1;
+    for (int i = 0; i < c->count; i++) {
+        unsigned s = c->files[i]->hash & (size - 1);
+        while (slots[s])
+            s = (s + 1) & (size - 1);
+        slots[s] = i + 1;
+    }
+    free(c->slots);
+    c->slots = slots;
+    c->mask = size - 1;
+    return 0;
+}
+
+// Add canonical path as a new file whose slot is slot.  The lock is held.
+static HeaderFile *addHeaderFile(HeaderCache *c, char *path, unsigned hash, unsigned slot) {
+    if (c->count == c->capacity) {
+        int capacity = c->capacity ? c->capacity * 2 : 64;
+        HeaderFile **files = realloc(c->files, capacity * sizeof(HeaderFile *));
+        if (!files)
+            return NULL;
+        c->files = files;
+        c->capacity = capacity;
+    }
+    HeaderFile *f = calloc(1, sizeof(HeaderFile));
+    if (!f)
+        return NULL;
+    f->path = path;
+    f->hash = hash;
+    f->id = c->count;
+    c->files[c->count++] = f;
+    c->slots[slot] = c->count;
+    if ((unsigned)c->count * 2 > c->mask)
+        growHeaderSlots(c);
+    return f;
+}
+
+// The file for canonical path, added if new (the cache takes path over
+// either way).  NULL if out of memory.
+static HeaderFile *headerFile(HeaderCache *c, char *path) {
+    unsigned hash = hashBytes(path, strlen(path));
+    pthread_mutex_lock(&c->lock);
+    unsigned s = hash & c->mask;
+    for (; c->slots[s]; s = (s + 1) & c->mask) {
+        HeaderFile *f = c->files[c->slots[s] - 1];
+        if (f->hash == hash && strcmp(f->path, path) == 0) {
+            pthread_mutex_unlock(&c->lock);
+            free(path);
+            return f;
+        }
+    }
+    HeaderFile *f = addHeaderFile(c, path, hash, s);
+    pthread_mutex_unlock(&c->lock);
+    if (!f)
+        free(path);
+    return f;
+}
+
+// The file at path, or NULL if it is not a regular file.
+static HeaderFile *headerFileAt(HeaderCache *c, const char *path) {
+    char *canonical = canonicalPath(path);
+    return canonical ? headerFile(c, canonical) : NULL;
+}
+
+// Canonical path of dir/name (dir may be empty), or NULL.
+static char *includeCandidate(const char *dir, size_t dirLen, const char *name, size_t nameLen) {
+    char *path = malloc(dirLen + nameLen + 2);
+    if (!path)
+        return NULL;
+    memcpy(path, dir, dirLen);
+    size_t at = dirLen;
+    if (dirLen && dir[dirLen - 1] != '/')
+        path[at++] = '/';
+    memcpy(path + at, name, nameLen);
+    path[at + nameLen] = '\0';
+    char *canonical = canonicalPath(path);
+    free(path);
+    return canonical;
+}
+
+// The file d names when included from file from, or NULL if it is not found.
+static HeaderFile *resolveInclude(HeaderCache *c, const HeaderFile *from, const Directive *d) {
+    char *path = NULL;
+    if (d->arg[0] == '/') {
+        path = includeCandidate("", 0, d->arg, d->argLen);
+    } else if (!d->angled) {
+        const char *slash = strrchr(from->path, '/');
+        path = includeCandidate(from->path, slash ? (size_t)(slash - from->path) : 0, d->arg, d->argLen);
+    }
+    for (int i = 0; !path && d->arg[0] != '/' && i < c->numDirs; i++)
+        path = includeCandidate(c->dirs[i], strlen(c->dirs[i]), d->arg, d->argLen);
+    return path ? headerFile(c, path) : NULL;
+}
+
+static void pushIncludeItem(IncludeItems *list, const IncludeItem *item) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        IncludeItem *items = realloc(list->items, capacity * sizeof(IncludeItem));
+        if (!items) {
+            list->failed = 1;
+            return;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = *item;
+}
+
+// LexerContext.declarationHook while a file is lexed; hookData is its list.
+static void recordIncludeItem(LexerContext *ctx, unsigned nameId, const char *declType) {
+    IncludeItem item = { internedString(&ctx->strings, nameId), ctx->strings.lengths[nameId], declType, NULL, 0 };
+    pushIncludeItem(ctx->hookData, &item);
+}
+
+// Lex src, the contents of f, into tokens (in ctx's scratch arena, with
+// positions) and reduce it to its items.  Whatever hook ctx has is set
+// aside meanwhile.
+static int lexIncludeItems(HeaderCache *c, const HeaderFile *f, LexerContext *ctx, SourceBuffer *src,
+                           TokenBuffer *tokens, IncludeItems *items) {
+    memset(items, 0, sizeof(*items));
+    beginLexing(ctx, src);
+    if (initTokenBufferIn(tokens, &ctx->scratch, 4096, 1) != 0 || lexTokens(ctx, c->lang, tokens, SIZE_MAX) < 0)
+        return -1;
+    void (*hook)(LexerContext *, unsigned, const char *) = ctx->declarationHook;
+    void *hookData = ctx->hookData;
+    ctx->declarationHook = recordIncludeItem;
+    ctx->hookData = items;
+    // Every token is checked for #include, not just those a collector step
+    // starts at: a step may take a directive as lookahead and step over it.
+    size_t next = 0;
+    for (size_t t = 0; t < tokens->count; t++) {
+        Directive d;
+        if (tokens->kinds[t] == TOKEN_DIRECTIVE &&
+            parseDirective(src->data + tokens->offsets[t], tokens->lengths[t], &d) == DIRECTIVE_INCLUDE) {
+            unsigned id = internString(&ctx->strings, d.arg - 1, d.argLen + 2);   // with its delimiters
+            IncludeItem item = { NULL, 0, internedString(&ctx->strings, id), resolveInclude(c, f, &d), t };
+            pushIncludeItem(items, &item);
+        }
+        if (t == next)
+            next = c->lang->collectSymbols(ctx, c->lang, tokens, t, t + 1);
+    }
+    ctx->declarationHook = hook;
+    ctx->hookData = hookData;
+    if (items->failed)
+        return -1;
+    atomic_fetch_add_explicit(&c->lexedFiles, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&c->lexedBytes, (long long)src->len, memory_order_relaxed);
+    return 0;
+}
+
+// Copy a lexed header into the cache as a version stamped with st.
+static HeaderVersion *storeHeaderVersion(HeaderCache *c, const SourceBuffer *src, const TokenBuffer *tokens,
+                                         const IncludeItems *items, const struct stat *st) {
+    pthread_mutex_lock(&c->lock);
+    HeaderVersion *v = arenaAllocAligned(&c->arena, sizeof(HeaderVersion));
+    IncludeItem *copies = arenaAllocAligned(&c->arena, (items->count ? items->count : 1) * sizeof(IncludeItem));
+    if (!v || !copies || copyTokenBufferIn(&v->tokens, &c->arena, tokens) != 0) {
+        pthread_mutex_unlock(&c->lock);
+        return NULL;
+    }
+    v->mtime = (long long)st->st_mtime;
+    v->size = (long long)st->st_size;
+    v->src = *src;
+    v->items = copies;
+    v->numItems = 0;
+    for (size_t k = 0; k < items->count; k++) {
+        IncludeItem item = items->items[k];
+        unsigned name = item.name ? internString(&c->strings, item.name, item.nameLen) : 0;
+        unsigned text = internString(&c->strings, item.text, strlen(item.text));
+        if ((item.name && !name) || !text) {
+            pthread_mutex_unlock(&c->lock);
+            return NULL;
+        }
+        item.name = name ? internedString(&c->strings, name) : NULL;
+        item.text = internedString(&c->strings, text);
+        copies[v->numItems++] = item;
+    }
+    v->next = c->versions;
+    c->versions = v;
+    pthread_mutex_unlock(&c->lock);
+    return v;
+}
+
+// Lex f as it is now into a new version, or NULL if it cannot be read.
+static HeaderVersion *lexHeaderVersion(HeaderCache *c, const HeaderFile *f, LexerContext *ctx,
+                                       const struct stat *st) {
+    SourceBuffer src;
+    if (srcOpen(&src, f->path) != 0)
+        return NULL;
+    TokenBuffer tokens;
+    IncludeItems items;
+    HeaderVersion *v = NULL;
+    ArenaMark mark = arenaMark(&ctx->scratch);
+    if (lexIncludeItems(c, f, ctx, &src, &tokens, &items) == 0)
+        v = storeHeaderVersion(c, &src, &tokens, &items, st);
+    arenaRelease(&ctx->scratch, mark);
+    free(items.items);
+    if (!v)
+        srcClose(&src);
+    return v;
+}
+
+// Wait until no other thread is checking f; then claim it if it has not
+// been checked in this generation.
+static int claimHeader(HeaderCache *c, HeaderFile *f) {
+    pthread_mutex_lock(&c->lock);
+    while (f->busy)
+        pthread_cond_wait(&c->idle, &c->lock);
+    int claimed = atomic_load_explicit(&f->checked, memory_order_relaxed) != c->generation;
+    f->busy = claimed;
+    pthread_mutex_unlock(&c->lock);
+    return claimed;
+}
+
+// Check a claimed f against the file system, lexing it again if its stamp
+// changed, and publish the result.
+static HeaderVersion *checkHeader(HeaderCache *c, HeaderFile *f, LexerContext *ctx) {
+    HeaderVersion *v = f->version;
+    struct stat st;
+    if (stat(f->path, &st) != 0) {
+        v = NULL;
+    } else if (v && v->mtime == (long long)st.st_mtime && v->size == (long long)st.st_size) {
+        atomic_fetch_add_explicit(&c->hits, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&c->misses, 1, memory_order_relaxed);
+        if (v)
+            atomic_fetch_add_explicit(&c->stale, 1, memory_order_relaxed);
+        v = lexHeaderVersion(c, f, ctx, &st);
+    }
+    pthread_mutex_lock(&c->lock);
+    f->version = v;
+    f->busy = 0;
+    atomic_store_explicit(&f->checked, c->generation, memory_order_release);
+    pthread_cond_broadcast(&c->idle);
+    pthread_mutex_unlock(&c->lock);
+    return v;
+}
+
+/*
+ * The current version of f, or NULL if it cannot be read.  A header
+ * already checked in this generation is returned without taking the lock.
+ * Otherwise one thread claims it, stats it and lexes it if its stamp
+ * changed (in ctx, whose symbols it leaves alone); any other thread that
+ * wants it meanwhile waits.  Lexing resolves the header's includes but
+ * does not check or lex them, so a thread never waits while it holds a
+ * claim.
+ */
+static HeaderVersion *headerVersion(HeaderCache *c, HeaderFile *f, LexerContext *ctx) {
+    if (atomic_load_explicit(&f->checked, memory_order_acquire) != c->generation && claimHeader(c, f))
+        return checkHeader(c, f, ctx);
+    atomic_fetch_add_explicit(&c->hits, 1, memory_order_relaxed);
+    return f->version;
+}
+
+// f's version if it has been checked in this generation, else NULL.
+static HeaderVersion *checkedVersion(const HeaderCache *c, HeaderFile *f) {
+    return atomic_load_explicit(&f->checked, memory_order_acquire) == c->generation ? f->version : NULL;
+}
+
+/* ---------------------------------------------------------------- walkers */
+
+typedef struct {
+    HeaderCache *cache;
+    LexerContext *ctx;           // the unit's symbols go to ctx->symbols
+    int *marks;                  // by file id: the last walk that reached the file
+    int capacity;
+    int walk;
+    // Counters for the summary.
+    int includes, missing, tooDeep;
+} IncludeWalker;
+
+// A unit being walked: its file lexed into the walker's scratch arena.
+typedef struct {
+    HeaderFile *file;
+    SourceBuffer src;
+    TokenBuffer tokens;
+    IncludeItems items;
+    ArenaMark mark;
+} TranslationUnit;
+
+static void initIncludeWalker(IncludeWalker *w, HeaderCache *cache, LexerContext *ctx) {
+    memset(w, 0, sizeof(*w));
+    w->cache = cache;
+    w->ctx = ctx;
+}
+
+static void freeIncludeWalker(IncludeWalker *w) {
+    free(w->marks);
+    memset(w, 0, sizeof(*w));
+}
+
+// f's mark, or NULL if out of memory.  Only good until the next call.
+static int *headerMark(IncludeWalker *w, const HeaderFile *f) {
+    if (f->id >= w->capacity) {
+        int capacity = w->capacity ? w->capacity : 64;
+        while (capacity <= f->id)
+            capacity *= 2;
+        int *marks = realloc(w->marks, capacity * sizeof(int));
+        if (!marks)
+            return NULL;
+        memset(marks + w->capacity, 0, (capacity - w->capacity) * sizeof(int));
+        w->marks = marks;
+        w->capacity = capacity;
+    }
+    return &w->marks[f->id];
+}
+
+// Start a walk from u: only u has been reached.
+static void beginWalk(IncludeWalker *w, const TranslationUnit *u) {
+    int *mark = headerMark(w, u->file);
+    w->walk++;
+    if (mark)
+        *mark = w->walk;
+}
+
+static int openTranslationUnit(IncludeWalker *w, const char *path, TranslationUnit *u) {
+    memset(u, 0, sizeof(*u));
+    if (!(u->file = headerFileAt(w->cache, path)) || srcOpen(&u->src, u->file->path) != 0)
+        return -1;
+    u->mark = arenaMark(&w->ctx->scratch);
+    if (lexIncludeItems(w->cache, u->file, w->ctx, &u->src, &u->tokens, &u->items) != 0) {
+        arenaRelease(&w->ctx->scratch, u->mark);
+        free(u->items.items);
+        srcClose(&u->src);
+        return -1;
+    }
+    return 0;
+}
+
+static void closeTranslationUnit(IncludeWalker *w, TranslationUnit *u) {
+    arenaRelease(&w->ctx->scratch, u->mark);
+    free(u->items.items);
+    srcClose(&u->src);
+}
+
+// Add the declarations among items to the unit's table, expanding the
+// includes not yet reached in this walk where they occur.
+static void expandIncludeItems(IncludeWalker *w, const IncludeItem *items, size_t count, int depth) {
+    for (size_t k = 0; k < count; k++) {
+        const IncludeItem *item = &items[k];
+        if (item->name) {
+            addSymbol(w->ctx, internString(&w->ctx->strings, item->name, item->nameLen), item->text);
+            continue;
+        }
+        w->includes++;
+        if (!item->header) {
+            w->missing++;
+            continue;
+        }
+        int *mark = headerMark(w, item->header);
+        if (!mark || *mark == w->walk)
+            continue;
+        if (depth + 1 >= INCLUDE_MAX_DEPTH) {
+            w->tooDeep++;
+            continue;
+        }
+        *mark = w->walk;
+        HeaderVersion *v = headerVersion(w->cache, item->header, w->ctx);
+        if (v)
+            expandIncludeItems(w, v->items, v->numItems, depth + 1);
+    }
+}
+
+// Build the symbol table of the translation unit at path in
+// w->ctx->symbols.  Returns -1 if it cannot be read.
+static int scanTranslationUnit(IncludeWalker *w, const char *path) {
+    TranslationUnit u;
+    if (openTranslationUnit(w, path, &u) != 0)
+        return -1;
+    resetSymbolTable(&w->ctx->symbols);
+    beginWalk(w, &u);
+    expandIncludeItems(w, u.items.items, u.items.count, 0);
+    closeTranslationUnit(w, &u);
+    return 0;
+}
+
+// The include tree under items, one line per file as in gcc -H, as far as
+// the unit's walk has checked it.
+static void printIncludeTree(IncludeWalker *w, const IncludeItem *items, size_t count, int depth) {
+    for (size_t k = 0; k < count; k++) {
+        const IncludeItem *item = &items[k];
+        int *mark = item->header ? headerMark(w, item->header) : NULL;
+        if (item->name || (item->header && (!mark || *mark == w->walk)))
+            continue;
+        for (int i = 0; i <= depth; i++)
+            outChar(&output, '.');
+        outChar(&output, ' ');
+        if (!item->header) {
+            outString(&output, item->text);
+            outString(&output, " (not found)\n");
+            continue;
+        }
+        outString(&output, item->header->path);
+        outChar(&output, '\n');
+        *mark = w->walk;
+        HeaderVersion *v = depth + 1 < INCLUDE_MAX_DEPTH ? checkedVersion(w->cache, item->header) : NULL;
+        if (v)
+            printIncludeTree(w, v->items, v->numItems, depth + 1);
+    }
+}
+
+// The tokens of a file with each include that expands (the first time its
+// header is reached) replaced by the header's tokens, recursively.
+static void printUnitTokens(IncludeWalker *w, const SourceBuffer *src, const TokenBuffer *tokens,
+                            const IncludeItem *items, size_t count, int depth) {
+    size_t k = 0;
+    for (size_t t = 0; t < tokens->count; t++) {
+        while (k < count && (items[k].name || items[k].token < t))
+            k++;
+        if (k < count && items[k].token == t && items[k].header && depth + 1 < INCLUDE_MAX_DEPTH) {
+            int *mark = headerMark(w, items[k].header);
+            if (mark && *mark != w->walk) {
+                *mark = w->walk;
+                HeaderVersion *v = headerVersion(w->cache, items[k].header, w->ctx);
+                if (v) {
+                    printUnitTokens(w, &v->src, &v->tokens, v->items, v->numItems, depth + 1);
+                    continue;
+                }
+            }
+        }
+        emitToken(tokens->kinds[t], src->data + tokens->offsets[t], tokens->lengths[t], tokens->positions[t].row,
+                  tokens->positions[t].col);
+    }
+}
+
+int runIncludes(const LanguageDescriptor *lang, int argc, char *argv[], const char *defaultPath) {
+    const char *path = defaultPath;
+    int graph = 0, tokens = 0;
+    HeaderCache cache;
+    if (initHeaderCache(&cache, lang) != 0) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-I") == 0 && i + 1 < argc)
+            addIncludeDir(&cache, argv[++i]);
+        else if (strncmp(argv[i], "-I", 2) == 0 && argv[i][2])
+            addIncludeDir(&cache, argv[i] + 2);
+        else if (strcmp(argv[i], "--graph") == 0)
+            graph = 1;
+        else if (strcmp(argv[i], "--tokens") == 0)
+            tokens = 1;
+        else
+            path = argv[i];
+    }
+
+    LexerContext ctx;
+    IncludeWalker w;
+    TranslationUnit u;
+    initLexerContext(&ctx);
+    initIncludeWalker(&w, &cache, &ctx);
+    beginHeaderRun(&cache);
+    if (openTranslationUnit(&w, path, &u) != 0) {
+        printf("Cannot open %s\n", path);
+        freeLexerContext(&ctx);
+        freeHeaderCache(&cache);
+        return 1;
+    }
+    beginWalk(&w, &u);
+    expandIncludeItems(&w, u.items.items, u.items.count, 0);
+    if (graph) {
+        outString(&output, u.file->path);
+        outChar(&output, '\n');
+        beginWalk(&w, &u);
+        printIncludeTree(&w, u.items.items, u.items.count, 0);
+    } else if (tokens) {
+        emitTokenHeader();
+        beginWalk(&w, &u);
+        printUnitTokens(&w, &u.src, &u.tokens, u.items.items, u.items.count, 0);
+    } else {
+        printSymbolTable(&ctx, lang);
+    }
+    closeTranslationUnit(&w, &u);
+    fprintf(stderr, "%d files lexed (%lld bytes), %d includes, %d not found", atomic_load(&cache.lexedFiles),
+            atomic_load(&cache.lexedBytes), w.includes, w.missing);
+    if (w.tooDeep)
+        fprintf(stderr, ", %d nested too deep", w.tooDeep);
+    fprintf(stderr, ", %d header cache hits, %d misses\n", atomic_load(&cache.hits), atomic_load(&cache.misses));
+    freeIncludeWalker(&w);
+    freeLexerContext(&ctx);
+    freeHeaderCache(&cache);
+    return 0;
+}
+
+#endif
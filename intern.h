@@ -0,0 +1,155 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+/*
+ * String interner shared by the lexer and the symbol table.
+ *
+ * Each distinct string is copied once into an arena (arena.h) and given a
+ * small integer id, so names compare by id and entries hold a pointer
+ * instead of a fixed char array; there is no length limit.  Strings are
+ * found by hash in an open-addressed slot table with linear probing, kept
+ * at most 3/4 full; ids are handed out in order of first sight, so the
+ * symbol table can index its entries by id directly (symtab.h).
+ *
+ * Each lexer context (lexctx.h) owns a pool, whose arena is also where
+ * the context's other long-lived strings come from.  Strings stay valid
+ * until the pool is freed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "hashfn.h"
+
+// The hash, length and string are kept next to the id so a probe costs
+// one cache miss for the slot and, on a likely match, one for the string.
+typedef struct {
+    const char *string;
+    unsigned id;            // 0 = empty
+    unsigned hash;
+    unsigned length;
+} InternSlot;
+
+typedef struct {
+    Arena arena;
+    const char **strings;   // by id; id 0 means "none"
+    unsigned *lengths;
+    unsigned count, capacity;   // ids in use (including 0), allocated
+    InternSlot *slots;
+    unsigned slotMask;
+} Interner;
+
+// Hash used for the id table; see hashfn.h.
+static inline unsigned hashBytes(const char *s, size_t len) {
+    return INTERN_HASH(s, len);
+}
+
+static int growInternSlots(Interner *in) {
+    unsigned size = in->slots ? (in->slotMask + 1) * 2 : 256;
+    InternSlot *slots = calloc(size, sizeof(InternSlot));
+    if (!slots)
+        return -1;
+    for (unsigned i = 0; in->slots && i <= in->slotMask; i++) {
+        if (in->slots[i].id == 0)
+            continue;
+        unsigned s = in->slots[i].hash & (size - 1);
+        while (slots[s].id != 0)
+            s = (s + 1) & (size - 1);
+        slots[s] = in->slots[i];
+    }
+    free(in->slots);
+    in->slots = slots;
+    in->slotMask = size - 1;
+    return 0;
+}
+
+static int growInternIds(Interner *in) {
+    unsigned capacity = in->capacity ? in->capacity * 2 : 256;
+    const char **strings = realloc(in->strings, capacity * sizeof(char *));
+    if (!strings)
+        return -1;
+    in->strings = strings;
+    unsigned *lengths = realloc(in->lengths, capacity * sizeof(unsigned));
+    if (!lengths)
+        return -1;
+    in->lengths = lengths;
+    in->capacity = capacity;
+    if (in->count == 0) {
+        in->strings[0] = "";
+        in->lengths[0] = 0;
+        in->count = 1;
+    }
+    return 0;
+}
+
+// Slot holding s[0..len), or the empty slot where it would go.
+static inline unsigned findInternSlot(const Interner *in, const char *s, size_t len, unsigned hash) {
+    unsigned slot = hash & in->slotMask;
+    unsigned id;
+    LEXSTATS(uint64_t probes = 0;)
+    while ((id = in->slots[slot].id) != 0) {
+        // Lexemes may contain NUL bytes, so compare lengths and bytes, not C strings.
+        const InternSlot *t = &in->slots[slot];
+        if (t->hash == hash && t->length == len && memcmp(t->string, s, len) == 0)
+            break;
+        slot = (slot + 1) & in->slotMask;
+        LEXSTATS(probes++;)
+    }
+    LEXSTATS(lexStatsProbe(probes);)
+    return slot;
+}
+
+// Id of s[0..len), adding it if needed; 0 if out of memory.
+static unsigned internString(Interner *in, const char *s, size_t len) {
+    if (in->count + 1 >= in->capacity && growInternIds(in) != 0)
+        return 0;
+    // Keep the load factor at or below 3/4.
+    if (!in->slots || (in->count + 1) * 4 > (in->slotMask + 1) * 3) {
+        if (growInternSlots(in) != 0)
+            return 0;
+    }
+    unsigned hash = hashBytes(s, len);
+    unsigned slot = findInternSlot(in, s, len, hash);
+    if (in->slots[slot].id != 0)
+        return in->slots[slot].id;
+
+    char *copy = arenaAlloc(&in->arena, len + 1);
+    if (!copy)
+        return 0;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    unsigned id = in->count++;
+    in->strings[id] = copy;
+    in->lengths[id] = (unsigned)len;
+    in->slots[slot].string = copy;
+    in->slots[slot].id = id;
+    in->slots[slot].hash = hash;
+    in->slots[slot].length = (unsigned)len;
+    return id;
+}
+
+// Id of s[0..len) if it has been interned, else 0.
+static inline unsigned findInterned(const Interner *in, const char *s, size_t len) {
+    if (!in->slots)
+        return 0;
+    return in->slots[findInternSlot(in, s, len, hashBytes(s, len))].id;
+}
+
+static inline const char *internedString(const Interner *in, unsigned id) {
+    return in->strings[id];
+}
+
+// Interned copy of a NUL-terminated string.
+static inline const char *intern(Interner *in, const char *s) {
+    return internedString(in, internString(in, s, strlen(s)));
+}
+
+static void freeInterner(Interner *in) {
+    freeArena(&in->arena);
+    free(in->strings);
+    free(in->lengths);
+    free(in->slots);
+    memset(in, 0, sizeof(*in));
+}
+
+#endif
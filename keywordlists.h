@@ -0,0 +1,58 @@
+#ifndef KEYWORDLISTS_H
+#define KEYWORDLISTS_H
+
+/*
+ * Keyword lists for each language.  These are the source of truth: the
+ * lookup functions in keywords.h are generated from them by kwgen.c, so
+ * rerun `gcc kwgen.c -o kwgen && ./kwgen > keywords.h` after editing.
+ */
+
+static const char *const javascriptKeywords[] = {
+    "break", "case", "catch", "class", "const", "continue", "debugger",
+    "default", "delete", "do", "else", "export", "extends", "finally",
+    "for", "function", "if", "import", "in", "instanceof", "new", "return",
+    "super", "switch", "this", "throw", "try", "typeof", "var", "void",
+    "while", "with", "yield", "let"
+};
+
+// List of C keywords (a subset)
+static const char *const cKeywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if",
+    "inline", "int", "long", "register", "restrict", "return", "short",
+    "signed", "sizeof", "static", "struct", "switch", "typedef", "union",
+    "unsigned", "void", "volatile", "while"
+};
+
+// List of Java keywords (a subset)
+static const char *const javaKeywords[] = {
+    "abstract", "assert", "boolean", "break", "byte", "case", "catch",
+    "char", "class", "const", "continue", "default", "do", "double",
+    "else", "enum", "extends", "final", "finally", "float", "for",
+    "if", "implements", "import", "instanceof", "int", "interface",
+    "long", "native", "new", "package", "private", "protected",
+    "public", "return", "short", "static", "strictfp", "super", "switch",
+    "synchronized", "this", "throw", "throws", "transient", "try",
+    "void", "volatile", "while"
+};
+
+static const char *const csharpKeywords[] = {
+    "abstract", "as", "base", "bool", "break", "byte", "case", "catch", "char",
+    "checked", "class", "const", "continue", "decimal", "default", "delegate", "do",
+    "double", "else", "enum", "event", "explicit", "extern", "false", "finally",
+    "fixed", "float", "for", "foreach", "goto", "if", "implicit", "in", "int",
+    "interface", "internal", "is", "lock", "long", "namespace", "new", "null",
+    "object", "operator", "out", "override", "params", "private", "protected",
+    "public", "readonly", "ref", "return", "sbyte", "sealed", "short", "sizeof",
+    "stackalloc", "static", "string", "struct", "switch", "this", "throw", "true",
+    "try", "typeof", "uint", "ulong", "unchecked", "unsafe", "ushort", "using",
+    "virtual", "void", "volatile", "while"
+};
+
+// For Ruby, we only treat "def" as a keyword for function definitions.
+static const char *const rubyKeywords[] = { "def" };
+
+// For Perl, we only treat "sub" as a keyword that marks a function definition.
+static const char *const perlKeywords[] = { "sub" };
+
+#endif
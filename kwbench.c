@@ -0,0 +1,98 @@
+// Keyword lookup microbenchmark: per-identifier cost of the original linear
+// strcmp scan over the keyword list versus the generated perfect hash.
+//
+//     gcc -O2 kwbench.c -o kwbench && ./kwbench [identifiers]
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "languages.h"
+
+#define PASSES 10
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The lookup every scanner used to do for each identifier.
+static int linearKeywordIndex(const LanguageDescriptor *lang, const char *lexeme) {
+    for (int j = 0; j < lang->numKeywords; j++) {
+        if (strcmp(lexeme, lang->keywords[j]) == 0)
+            return j;
+    }
+    return -1;
+}
+
+// Roughly a third keywords, the rest identifiers of 1-15 characters.
+static char **makeIdentifiers(const LanguageDescriptor *lang, int count) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    char **ids = malloc(count * sizeof(char *));
+    srand(42);
+    for (int i = 0; i < count; i++) {
+        if (rand() % 3 == 0) {
+            ids[i] = strdup(lang->keywords[rand() % lang->numKeywords]);
+            continue;
+        }
+        int len = 1 + rand() % 15;
+        ids[i] = malloc(len + 1);
+        ids[i][0] = alphabet[rand() % 53];
+        for (int k = 1; k < len; k++)
+            ids[i][k] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        ids[i][len] = '\0';
+    }
+    return ids;
+}
+
+static void benchLanguage(const LanguageDescriptor *lang, int count) {
+    char **ids = makeIdentifiers(lang, count);
+    int *lengths = malloc(count * sizeof(int));
+    for (int i = 0; i < count; i++)
+        lengths[i] = (int)strlen(ids[i]);
+
+    for (int i = 0; i < count; i++) {
+        if (linearKeywordIndex(lang, ids[i]) != lang->keywordIndex(ids[i], lengths[i])) {
+            printf("%s: lookup mismatch for \"%s\"\n", lang->name, ids[i]);
+            exit(1);
+        }
+    }
+
+    long checksum = 0;
+    double start = nowSeconds();
+    for (int pass = 0; pass < PASSES; pass++)
+        for (int i = 0; i < count; i++)
+            checksum += linearKeywordIndex(lang, ids[i]);
+    double linear = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (int pass = 0; pass < PASSES; pass++)
+        for (int i = 0; i < count; i++)
+            checksum -= lang->keywordIndex(ids[i], lengths[i]);
+    double hashed = nowSeconds() - start;
+
+    double lookups = (double)count * PASSES;
+    printf("%-12s %8d %12.2f %12.2f %9.1fx%s\n", lang->name, lang->numKeywords,
+           linear * 1e9 / lookups, hashed * 1e9 / lookups, linear / hashed,
+           checksum ? "  (checksum mismatch)" : "");
+
+    for (int i = 0; i < count; i++)
+        free(ids[i]);
+    free(ids);
+    free(lengths);
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    const LanguageDescriptor *langs[] = {
+        &javascriptLanguage, &cLanguage, &javaLanguage,
+        &csharpLanguage, &rubyLanguage, &perlLanguage
+    };
+
+    printf("%d identifiers x %d passes\n", count, PASSES);
+    printf("%-12s %8s %12s %12s %10s\n", "Language", "Keywords", "linear ns", "hashed ns", "speedup");
+    for (size_t i = 0; i < sizeof(langs) / sizeof(langs[0]); i++)
+        benchLanguage(langs[i], count);
+    return 0;
+}
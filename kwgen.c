@@ -0,0 +1,143 @@
+// Keyword table generator: writes keywords.h from the lists in keywordlists.h.
+//
+//     gcc kwgen.c -o kwgen && ./kwgen > keywords.h
+//
+// For each language it searches for a perfect hash of the form
+//
+//     slot = (len + asso0[s[0]] + asso1[s[1]] + assoLast[s[len - 1]]) & (slots - 1)
+//
+// that places every keyword in its own slot, so recognising a keyword costs
+// three table loads, one length check and one memcmp instead of a strcmp
+// against every entry of the list.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "keywordlists.h"
+
+#define MAX_TRIES 20000
+#define MAX_SLOTS 4096
+
+typedef struct {
+    const char *name;
+    const char *const *keywords;
+    int count;
+} KeywordList;
+
+static const KeywordList lists[] = {
+    { "javascript", javascriptKeywords, sizeof(javascriptKeywords) / sizeof(javascriptKeywords[0]) },
+    { "c", cKeywords, sizeof(cKeywords) / sizeof(cKeywords[0]) },
+    { "java", javaKeywords, sizeof(javaKeywords) / sizeof(javaKeywords[0]) },
+    { "csharp", csharpKeywords, sizeof(csharpKeywords) / sizeof(csharpKeywords[0]) },
+    { "ruby", rubyKeywords, sizeof(rubyKeywords) / sizeof(rubyKeywords[0]) },
+    { "perl", perlKeywords, sizeof(perlKeywords) / sizeof(perlKeywords[0]) },
+};
+
+// Fixed-seed generator so the emitted tables are reproducible.
+static unsigned long long rngState = 0x9e3779b97f4a7c15ULL;
+
+static unsigned nextRandom(void) {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(rngState >> 33);
+}
+
+static unsigned slotOf(unsigned short asso[3][256], const char *kw, unsigned mask) {
+    size_t len = strlen(kw);
+    const unsigned char *u = (const unsigned char *)kw;
+    return ((unsigned)len + asso[0][u[0]] + asso[1][u[1]] + asso[2][u[len - 1]]) & mask;
+}
+
+// Search for association values that give every keyword a distinct slot.
+static unsigned findPerfectHash(const KeywordList *list, unsigned short asso[3][256], int *slots) {
+    unsigned size = 2;
+    while (size < (unsigned)list->count * 2)
+        size *= 2;
+
+    for (; size <= MAX_SLOTS; size *= 2) {
+        for (int attempt = 0; attempt < MAX_TRIES; attempt++) {
+            memset(asso, 0, 3 * 256 * sizeof(unsigned short));
+            for (int k = 0; k < list->count; k++) {
+                const unsigned char *u = (const unsigned char *)list->keywords[k];
+                size_t len = strlen(list->keywords[k]);
+                // Every occurrence of a character in a position shares one value.
+                if (!asso[0][u[0]]) asso[0][u[0]] = 1 + nextRandom() % size;
+                if (!asso[1][u[1]]) asso[1][u[1]] = 1 + nextRandom() % size;
+                if (!asso[2][u[len - 1]]) asso[2][u[len - 1]] = 1 + nextRandom() % size;
+            }
+            for (unsigned s = 0; s < size; s++)
+                slots[s] = -1;
+            int ok = 1;
+            for (int k = 0; k < list->count && ok; k++) {
+                unsigned s = slotOf(asso, list->keywords[k], size - 1);
+                if (slots[s] >= 0)
+                    ok = 0;
+                else
+                    slots[s] = k;
+            }
+            if (ok)
+                return size;
+        }
+    }
+    fprintf(stderr, "kwgen: no perfect hash found for %s\n", list->name);
+    exit(1);
+}
+
+static void emitList(const KeywordList *list) {
+    unsigned short asso[3][256];
+    int slots[MAX_SLOTS];
+    int minLen = 1 << 30, maxLen = 0;
+
+    for (int k = 0; k < list->count; k++) {
+        int len = (int)strlen(list->keywords[k]);
+        if (len < 2) {
+            fprintf(stderr, "kwgen: %s keyword \"%s\" is shorter than 2 characters\n",
+                    list->name, list->keywords[k]);
+            exit(1);
+        }
+        if (len < minLen) minLen = len;
+        if (len > maxLen) maxLen = len;
+    }
+    unsigned size = findPerfectHash(list, asso, slots);
+
+    printf("/* %s: %d keywords in %u slots */\n\n", list->name, list->count, size);
+    printf("static const unsigned short %sKeywordAsso[3][256] = {\n", list->name);
+    for (int p = 0; p < 3; p++) {
+        printf("    {");
+        for (int c = 0; c < 256; c++)
+            printf("%s%u%s", c % 16 == 0 ? "\n        " : "", asso[p][c], c < 255 ? ", " : "");
+        printf("\n    },\n");
+    }
+    printf("};\n\n");
+
+    printf("static const signed char %sKeywordSlots[%u] = {", list->name, size);
+    for (unsigned s = 0; s < size; s++)
+        printf("%s%d%s", s % 16 == 0 ? "\n    " : "", slots[s], s + 1 < size ? ", " : "");
+    printf("\n};\n\n");
+
+    printf("static const unsigned char %sKeywordLengths[%d] = {", list->name, list->count);
+    for (int k = 0; k < list->count; k++)
+        printf("%s%d%s", k % 16 == 0 ? "\n    " : "", (int)strlen(list->keywords[k]),
+               k + 1 < list->count ? ", " : "");
+    printf("\n};\n\n");
+
+    printf("// Index of s[0..len) in %sKeywords, or -1 if it is not a keyword.\n", list->name);
+    printf("static int %sKeywordIndex(const char *s, int len) {\n", list->name);
+    printf("    if (len < %d || len > %d)\n        return -1;\n", minLen, maxLen);
+    printf("    const unsigned char *u = (const unsigned char *)s;\n");
+    printf("    int k = %sKeywordSlots[(len + %sKeywordAsso[0][u[0]] + %sKeywordAsso[1][u[1]] +\n",
+           list->name, list->name, list->name);
+    printf("                %sKeywordAsso[2][u[len - 1]]) & %u];\n", list->name, size - 1);
+    printf("    if (k < 0 || %sKeywordLengths[k] != len || memcmp(%sKeywords[k], s, len) != 0)\n",
+           list->name, list->name);
+    printf("        return -1;\n    return k;\n}\n\n");
+}
+
+int main(void) {
+    printf("/* Generated by kwgen.c from keywordlists.h -- do not edit. */\n");
+    printf("#ifndef KEYWORDS_H\n#define KEYWORDS_H\n\n");
+    printf("#include <string.h>\n#include \"keywordlists.h\"\n\n");
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
+        emitList(&lists[i]);
+    printf("#endif\n");
+    return 0;
+}
@@ -0,0 +1,400 @@
+#ifndef LANGUAGES_H
+#define LANGUAGES_H
+
+/*
+ * Per-language descriptors for the shared lexer core: keyword lookup (the
+ * lists themselves are in keywordlists.h), comment and identifier rules, and the declaration patterns each front
+ * end recognises when building its symbol table.
+ */
+
+#include "lexer.h"
+#include "tokbuf.h"
+#include "frontend.h"
+#include "keywords.h"
+
+/* ---------------------------------------------------------------- JavaScript */
+
+size_t collectJavaScriptSymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                                size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        // Handle variable declarations.
+        // If we see a variable declaration keyword (var, let, or const),
+        // then the next token should be the variable name.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD &&
+            (tokenIs(tokens, src, i, "var") ||
+             tokenIs(tokens, src, i, "let") ||
+             tokenIs(tokens, src, i, "const"))) {
+            // Save the declaration type for later use.
+            const char *declType = tokenText(ctx, tokens, i);
+
+            // Get the next token (which should be an identifier).
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), declType);
+            }
+            continue;
+        }
+
+        // Handle function declarations.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD && tokenIs(tokens, src, i, "function")) {
+            // Next token should be the function name.
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+            }
+            continue;
+        }
+    }
+    return i;
+}
+
+static LexTables javascriptTables;
+
+const LanguageDescriptor javascriptLanguage = {
+    .name = "JavaScript",
+    .lineComment = "//",
+    .identChars = "$",
+    .variableSigils = "",
+    .keywords = javascriptKeywords,
+    .numKeywords = sizeof(javascriptKeywords) / sizeof(javascriptKeywords[0]),
+    .keywordIndex = javascriptKeywordIndex,
+    .twoCharOperators = 1,
+    .tables = &javascriptTables,
+    .collectSymbols = collectJavaScriptSymbols,
+    .tableTitle = "Local Symbol Table:",
+    .showIndex = 0,
+    .extensions = ".js",
+};
+
+/* ------------------------------------------------------------------------ C */
+
+size_t collectCSymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                       size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        // A preprocessor line is one token; #define declares a macro.
+        if (tokenKind(tokens, i) == TOKEN_DIRECTIVE) {
+            Directive d;
+            if (parseDirective(src->data + tokens->offsets[i], tokens->lengths[i], &d) == DIRECTIVE_DEFINE)
+                addSymbol(ctx, internString(&ctx->strings, d.arg, d.argLen), "macro");
+            continue;
+        }
+
+        // For function detection in C:
+        // When a token is a valid C type (e.g., int, float, char, double, void), we treat it as a return type candidate.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD &&
+            (tokenIs(tokens, src, i, "int") || tokenIs(tokens, src, i, "float") ||
+             tokenIs(tokens, src, i, "char") || tokenIs(tokens, src, i, "double") ||
+             tokenIs(tokens, src, i, "void"))) {
+
+            // Save the return type.
+            const char *returnType = tokenText(ctx, tokens, i);
+
+            // Next token should be an identifier.
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                // Peek the next non-whitespace character to check for '('.
+                if (peekCharAfter(tokens, src, i) == '(') {
+                    // This is a function declaration.
+                    addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+                } else {
+                    // Otherwise, it's a variable declaration.
+                    addSymbol(ctx, tokenId(ctx, tokens, i), returnType);
+                }
+                continue;
+            }
+        }
+    }
+    return i;
+}
+
+static LexTables cTables;
+
+const LanguageDescriptor cLanguage = {
+    .name = "C",
+    .lineComment = "//",
+    .identChars = "",
+    .variableSigils = "",
+    .keywords = cKeywords,
+    .numKeywords = sizeof(cKeywords) / sizeof(cKeywords[0]),
+    .keywordIndex = cKeywordIndex,
+    .twoCharOperators = 1,
+    .blockComments = 1,
+    .directives = 1,
+    .tables = &cTables,
+    .collectSymbols = collectCSymbols,
+    .tableTitle = "C Symbol Table:",
+    .showIndex = 1,
+    .extensions = ".c .h",
+};
+
+/* --------------------------------------------------------------------- Java */
+
+size_t collectJavaSymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                          size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        // Variable declarations: check for keywords "int", "float", etc. or "var", "let", "const".
+        // Note that "String" is not a keyword, so it matches whatever its token type.
+        if ((tokenKind(tokens, i) == TOKEN_KEYWORD &&
+             (tokenIs(tokens, src, i, "int") || tokenIs(tokens, src, i, "float") ||
+              tokenIs(tokens, src, i, "double") || tokenIs(tokens, src, i, "char") ||
+              tokenIs(tokens, src, i, "boolean") || tokenIs(tokens, src, i, "var") ||
+              tokenIs(tokens, src, i, "let") || tokenIs(tokens, src, i, "const"))) ||
+            tokenIs(tokens, src, i, "String")) {
+            const char *declType = tokenText(ctx, tokens, i);
+            // Next token should be an identifier.
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), declType);
+            }
+            continue;
+        }
+
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD &&
+            (tokenIs(tokens, src, i, "void") || tokenIs(tokens, src, i, "int") ||
+             tokenIs(tokens, src, i, "string") || tokenIs(tokens, src, i, "bool") ||
+             tokenIs(tokens, src, i, "float") || tokenIs(tokens, src, i, "double") ||
+             tokenIs(tokens, src, i, "char"))) {
+            const char *retType = tokenText(ctx, tokens, i);
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                // Look ahead for '('
+                if (peekCharAfter(tokens, src, i) == '(')
+                    addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+                else
+                    addSymbol(ctx, tokenId(ctx, tokens, i), retType);
+            }
+            continue;
+        }
+    }
+    return i;
+}
+
+static LexTables javaTables;
+
+const LanguageDescriptor javaLanguage = {
+    .name = "Java",
+    .lineComment = "//",
+    .identChars = "",
+    .variableSigils = "",
+    .keywords = javaKeywords,
+    .numKeywords = sizeof(javaKeywords) / sizeof(javaKeywords[0]),
+    .keywordIndex = javaKeywordIndex,
+    .twoCharOperators = 1,
+    .tables = &javaTables,
+    .collectSymbols = collectJavaSymbols,
+    .tableTitle = "Java Symbol Table:",
+    .showIndex = 0,
+    .extensions = ".java",
+};
+
+/* ----------------------------------------------------------------------- C# */
+
+size_t collectCSharpSymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                            size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        // For C#, variable declarations might use keywords like int, string, bool, var, etc.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD &&
+            (tokenIs(tokens, src, i, "int") || tokenIs(tokens, src, i, "string") ||
+             tokenIs(tokens, src, i, "bool") || tokenIs(tokens, src, i, "float") ||
+             tokenIs(tokens, src, i, "double") || tokenIs(tokens, src, i, "char") ||
+             tokenIs(tokens, src, i, "var"))) {
+            const char *declType = tokenText(ctx, tokens, i);
+            // Next token should be the identifier (variable name)
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), declType);
+            }
+            continue;
+        }
+
+        // For function declarations, a common pattern is a return type followed by an identifier and then "(".
+        // For simplicity, if we see "void" or a known type and then an id followed by "(" we add it as a function.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD &&
+            (tokenIs(tokens, src, i, "void") || tokenIs(tokens, src, i, "int") ||
+             tokenIs(tokens, src, i, "string") || tokenIs(tokens, src, i, "bool") ||
+             tokenIs(tokens, src, i, "float") || tokenIs(tokens, src, i, "double") ||
+             tokenIs(tokens, src, i, "char"))) {
+            const char *retType = tokenText(ctx, tokens, i);
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                // Look ahead for '('
+                if (peekCharAfter(tokens, src, i) == '(')
+                    addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+                else
+                    addSymbol(ctx, tokenId(ctx, tokens, i), retType);
+            }
+            continue;
+        }
+    }
+    return i;
+}
+
+static LexTables csharpTables;
+
+const LanguageDescriptor csharpLanguage = {
+    .name = "C#",
+    .lineComment = "//",
+    .identChars = "",
+    .variableSigils = "",
+    .keywords = csharpKeywords,
+    .numKeywords = sizeof(csharpKeywords) / sizeof(csharpKeywords[0]),
+    .keywordIndex = csharpKeywordIndex,
+    .twoCharOperators = 1,
+    .tables = &csharpTables,
+    .collectSymbols = collectCSharpSymbols,
+    .tableTitle = "C# Symbol Table:",
+    .showIndex = 0,
+    .extensions = ".cs",
+};
+
+/* --------------------------------------------------------------------- Ruby */
+
+size_t collectRubySymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                          size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        int kind = tokenKind(tokens, i);
+
+        // Look for function definitions: keyword "def" followed by an identifier.
+        if (kind == TOKEN_KEYWORD && tokenIs(tokens, src, i, "def")) {
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+            }
+        }
+
+        if (kind == TOKEN_ID)
+            addSymbol(ctx, tokenId(ctx, tokens, i), "variable");
+    }
+    return i;
+}
+
+// Does the token at offset start a statement (so "if" or "while" there opens
+// a block instead of being a modifier)?
+static int rubyStatementStart(const SourceBuffer *src, size_t offset) {
+    while (offset > 0 && (src->data[offset - 1] == ' ' || src->data[offset - 1] == '\t' ||
+                          src->data[offset - 1] == '\r'))
+        offset--;
+    return offset == 0 || strchr("\n;=(,[{|", src->data[offset - 1]) != NULL;
+}
+
+// Ruby blocks: braces, and the keywords closed by "end".  Only "def" is a
+// keyword to the lexer, so the others are matched by their text.  *state
+// holds the offset (+ 1) of a while/until/for that opened a block, so an
+// optional "do" later on the same line does not open a second one.
+int rubyScopeDelta(const SourceBuffer *src, const TokenBuffer *tokens, size_t i, size_t *state) {
+    int kind = tokens->kinds[i];
+    if (kind == TOKEN_OPERATOR)
+        return braceScopeDelta(src, tokens, i, state);
+    if (kind != TOKEN_KEYWORD && kind != TOKEN_ID)
+        return 0;
+    size_t offset = tokens->offsets[i];
+    if (tokenIs(tokens, src, i, "end"))
+        return -1;
+    if (tokenIs(tokens, src, i, "def") || tokenIs(tokens, src, i, "class") ||
+        tokenIs(tokens, src, i, "module") || tokenIs(tokens, src, i, "begin") ||
+        tokenIs(tokens, src, i, "case"))
+        return 1;
+    if (tokenIs(tokens, src, i, "if") || tokenIs(tokens, src, i, "unless"))
+        return rubyStatementStart(src, offset);
+    if (tokenIs(tokens, src, i, "while") || tokenIs(tokens, src, i, "until") ||
+        tokenIs(tokens, src, i, "for")) {
+        if (!rubyStatementStart(src, offset))
+            return 0;
+        *state = offset + 1;
+        return 1;
+    }
+    if (tokenIs(tokens, src, i, "do")) {
+        size_t loop = *state;
+        *state = 0;
+        if (loop && !memchr(src->data + loop - 1, '\n', offset - (loop - 1)) &&
+            !memchr(src->data + loop - 1, ';', offset - (loop - 1)))
+            return 0;
+        return 1;
+    }
+    return 0;
+}
+
+static LexTables rubyTables;
+
+const LanguageDescriptor rubyLanguage = {
+    .name = "Ruby",
+    .lineComment = "#",
+    .identChars = "@$",
+    .variableSigils = "",
+    .keywords = rubyKeywords,
+    .numKeywords = sizeof(rubyKeywords) / sizeof(rubyKeywords[0]),
+    .keywordIndex = rubyKeywordIndex,
+    .twoCharOperators = 0,
+    .tables = &rubyTables,
+    .collectSymbols = collectRubySymbols,
+    .scopeDelta = rubyScopeDelta,
+    .tableTitle = "Ruby Symbol Table:",
+    .showIndex = 0,
+    .extensions = ".rb",
+};
+
+/* --------------------------------------------------------------------- Perl */
+
+size_t collectPerlSymbols(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                          size_t begin, size_t end) {
+    const SourceBuffer *src = ctx->src;
+    (void)lang;
+
+    size_t i;
+    for (i = begin; i < end; i++) {
+        // Look for function definitions: keyword "sub" followed by an identifier.
+        if (tokenKind(tokens, i) == TOKEN_KEYWORD && tokenIs(tokens, src, i, "sub")) {
+            i++;
+            if (tokenKind(tokens, i) == TOKEN_ID) {
+                addSymbol(ctx, tokenId(ctx, tokens, i), "function");
+            }
+            continue;
+        }
+
+        // Variables are recognised by their sigils ($, @, %).
+        if (tokenKind(tokens, i) == TOKEN_VARIABLE) {
+            addSymbol(ctx, tokenId(ctx, tokens, i), "variable");
+        }
+    }
+    return i;
+}
+
+static LexTables perlTables;
+
+const LanguageDescriptor perlLanguage = {
+    .name = "Perl",
+    .lineComment = "#",
+    .identChars = "$@%",
+    .variableSigils = "$@%",
+    .keywords = perlKeywords,
+    .numKeywords = sizeof(perlKeywords) / sizeof(perlKeywords[0]),
+    .keywordIndex = perlKeywordIndex,
+    .twoCharOperators = 1,
+    .tables = &perlTables,
+    .collectSymbols = collectPerlSymbols,
+    .tableTitle = "Perl Symbol Table:",
+    .showIndex = 0,
+    .extensions = ".pl .pm",
+};
+
+#endif
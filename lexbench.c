@@ -0,0 +1,524 @@
+// Lexer throughput benchmark over synthetic corpora.
+//
+// For every language and corpus shape this generates a large input in
+// memory, then times a getNextToken pass ("tokens") and a
+// generateSymbolTable pass ("symbols") over it and reports MB/s, tokens/s,
+// ns/token and the peak RSS of the run.
+//
+//     gcc -O2 -pthread lexbench.c -o lexbench
+//     ./lexbench [--size MB] [--runs N] [--lang name] [--corpus name]
+//                [--json file] [--label text] [--baseline file]
+//                [--save-corpus dir]
+//
+// Languages are javascript, c, java, csharp, ruby and perl; corpora are
+// mixed, nested, strings, operators and comments.  --json appends one JSON
+// object per line for each case, tagged with --label (a commit id, say), so
+// results from two commits can be diffed; --baseline reads such a file and
+// adds the ns/token change against it to the table.  --save-corpus writes
+// the generated inputs out for use with the other tools.
+//
+// Times are the best of --runs passes.  Each case runs in its own child
+// process so peak RSS belongs to that case alone.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "languages.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ------------------------------------------------------------ generators */
+
+// The bits of syntax the generators need for each language.  Formats take
+// the name number and then the value (or the bound for conditions).
+typedef struct {
+    const char *name;              // command-line name
+    const char *ext;               // for --save-corpus
+    const LanguageDescriptor *lang;
+    const char *assign;            // declaration: number, value text
+    const char *funcOpen;          // number
+    const char *funcClose;
+    const char *blockOpen;         // number, bound
+    const char *blockClose;
+} Dialect;
+
+static const Dialect dialects[] = {
+    { "javascript", ".js", &javascriptLanguage, "var v%u = %s;", "function f%u(a, b) {", "}",
+      "if (v%u > %u) {", "}" },
+    { "c", ".c", &cLanguage, "int v%u = %s;", "int f%u(int a, int b) {", "}",
+      "if (v%u > %u) {", "}" },
+    { "java", ".java", &javaLanguage, "int v%u = %s;", "public static int f%u(int a, int b) {", "}",
+      "if (v%u > %u) {", "}" },
+    { "csharp", ".cs", &csharpLanguage, "int v%u = %s;", "public static int f%u(int a, int b) {", "}",
+      "if (v%u > %u) {", "}" },
+    { "ruby", ".rb", &rubyLanguage, "v%u = %s", "def f%u(a, b)", "end",
+      "if v%u > %u", "end" },
+    { "perl", ".pl", &perlLanguage, "my $v%u = %s;", "sub f%u {", "}",
+      "if ($v%u > %u) {", "}" },
+};
+
+#define NUM_DIALECTS (sizeof(dialects) / sizeof(dialects[0]))
+
+typedef struct {
+    char *data;
+    size_t len, capacity;
+    unsigned seed;
+} Corpus;
+
+static unsigned nextRandom(Corpus *c) {
+    // xorshift32: fixed seed, so every run sees the same input.
+    c->seed ^= c->seed << 13;
+    c->seed ^= c->seed >> 17;
+    c->seed ^= c->seed << 5;
+    return c->seed;
+}
+
+static void emit(Corpus *c, const char *fmt, ...) {
+    va_list ap;
+    for (;;) {
+        va_start(ap, fmt);
+        int n = vsnprintf(c->data + c->len, c->capacity - c->len, fmt, ap);
+        va_end(ap);
+        if (n < 0)
+            return;
+        if ((size_t)n < c->capacity - c->len) {
+            c->len += (size_t)n;
+            return;
+        }
+        size_t capacity = c->capacity * 2 + (size_t)n;
+        char *data = realloc(c->data, capacity);
+        if (!data) {
+            fprintf(stderr, "lexbench: out of memory\n");
+            exit(1);
+        }
+        c->data = data;
+        c->capacity = capacity;
+    }
+}
+
+static void emitIndent(Corpus *c, int depth) {
+    emit(c, "%*s", depth * 4, "");
+}
+
+// Declarations, calls and conditions in roughly the proportions of the
+// sample files.
+static void genMixed(Corpus *c, const Dialect *d) {
+    unsigned n = nextRandom(c) % 100000;
+    emit(c, d->funcOpen, n);
+    emit(c, "\n");
+    for (int i = 0; i < 6; i++) {
+        unsigned v = nextRandom(c) % 100000;
+        char value[32];
+        snprintf(value, sizeof(value), "%u", v % 1000);
+        emitIndent(c, 1);
+        emit(c, d->assign, v, value);
+        emit(c, "\n");
+        if (i % 3 == 2) {
+            emitIndent(c, 1);
+            emit(c, d->blockOpen, v, v % 100);
+            emit(c, "\n");
+            emitIndent(c, 2);
+            emit(c, "print(\"v%u\", a + b * %u)\n", v, v % 7);
+            emitIndent(c, 1);
+            emit(c, "%s\n", d->blockClose);
+        }
+    }
+    emit(c, "%s\n\n", d->funcClose);
+}
+
+// Blocks nested 32 deep.
+static void genNested(Corpus *c, const Dialect *d) {
+    enum { DEPTH = 32 };
+    unsigned base = nextRandom(c) % 100000;
+    emit(c, d->funcOpen, base);
+    emit(c, "\n");
+    for (int k = 1; k <= DEPTH; k++) {
+        emitIndent(c, k);
+        emit(c, d->blockOpen, base + k, (unsigned)k);
+        emit(c, "\n");
+    }
+    for (int k = DEPTH; k >= 1; k--) {
+        emitIndent(c, k);
+        emit(c, "%s\n", d->blockClose);
+    }
+    emit(c, "%s\n", d->funcClose);
+}
+
+// Declarations whose values are string literals of 100-400 bytes.
+static void genStrings(Corpus *c, const Dialect *d) {
+    static const char words[] = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod ";
+    char value[512];
+    size_t len = 100 + nextRandom(c) % 300, n = 1;
+    value[0] = '"';
+    while (n < len + 1) {
+        value[n] = words[(n + c->seed) % (sizeof(words) - 1)];
+        n++;
+    }
+    value[n++] = '"';
+    value[n] = '\0';
+    emit(c, d->assign, nextRandom(c) % 100000, value);
+    emit(c, "\n");
+}
+
+// Arithmetic and comparisons with one- and two-character operators.
+static void genOperators(Corpus *c, const Dialect *d) {
+    (void)d;
+    unsigned a = nextRandom(c) % 1000;
+    emit(c, "x%u = ((a%u+b)*(c-d%u))/(e%%f)+[g,h]-{i:j}<=k>=l==m!=n<o>p;\n", a, a, a % 10);
+}
+
+// Several comment lines for every statement.
+static void genComments(Corpus *c, const Dialect *d) {
+    const char *comment = d->lang->lineComment;
+    unsigned v = nextRandom(c) % 100000;
+    emit(c, "%s Compute v%u from the running totals; see the note above.\n", comment, v);
+    emit(c, "%s The value is clamped to the range of the table below.\n", comment);
+    emit(c, "%s\n", comment);
+    emit(c, d->assign, v, "0");
+    emit(c, "  %s trailing note\n", comment);
+}
+
+typedef struct {
+    const char *name;
+    void (*generate)(Corpus *c, const Dialect *d);
+} CorpusShape;
+
+static const CorpusShape shapes[] = {
+    { "mixed", genMixed },
+    { "nested", genNested },
+    { "strings", genStrings },
+    { "operators", genOperators },
+    { "comments", genComments },
+};
+
+#define NUM_SHAPES (sizeof(shapes) / sizeof(shapes[0]))
+
+static void generateCorpus(Corpus *c, const Dialect *d, const CorpusShape *shape, size_t size) {
+    memset(c, 0, sizeof(*c));
+    c->capacity = size + 4096;
+    c->data = malloc(c->capacity);
+    c->seed = 2463534242u;
+    if (!c->data) {
+        fprintf(stderr, "lexbench: out of memory\n");
+        exit(1);
+    }
+    while (c->len < size)
+        shape->generate(c, d);
+}
+
+/* -------------------------------------------------------------- measuring */
+
+typedef struct {
+    const char *language, *corpus, *mode;
+    size_t bytes, tokens;
+    double seconds;          // best run
+    long peakRssKb;          // -1 if unknown
+} BenchResult;
+
+static size_t countTokens(const LanguageDescriptor *lang, SourceBuffer *src) {
+    size_t count = 0;
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, src);
+    while (getNextToken(&ctx, lang).kind != TOKEN_EOF)
+        count++;
+    return count;
+}
+
+static double timeTokens(const LanguageDescriptor *lang, SourceBuffer *src) {
+    double start = nowSeconds();
+    countTokens(lang, src);
+    return nowSeconds() - start;
+}
+
+static double timeSymbols(const LanguageDescriptor *lang, SourceBuffer *src) {
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    double start = nowSeconds();
+    generateSymbolTable(&ctx, lang, src);
+    double seconds = nowSeconds() - start;
+    freeLexerContext(&ctx);
+    return seconds;
+}
+
+static long peakRssKb(void) {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;   // kilobytes on Linux
+#endif
+    return -1;
+}
+
+static void runCase(const Dialect *d, const CorpusShape *shape, const char *mode, size_t size, int runs,
+                    BenchResult *r) {
+    Corpus corpus;
+    generateCorpus(&corpus, d, shape, size);
+    SourceBuffer src = { corpus.data, corpus.len, 0, 0 };
+
+    memset(r, 0, sizeof(*r));
+    r->language = d->name;
+    r->corpus = shape->name;
+    r->mode = mode;
+    r->bytes = corpus.len;
+    r->tokens = countTokens(d->lang, &src);
+    r->seconds = -1;
+    for (int i = 0; i < runs; i++) {
+        double s = strcmp(mode, "tokens") == 0 ? timeTokens(d->lang, &src) : timeSymbols(d->lang, &src);
+        if (r->seconds < 0 || s < r->seconds)
+            r->seconds = s;
+    }
+    r->peakRssKb = peakRssKb();
+    free(corpus.data);
+}
+
+// Run the case in a child so its peak RSS is its own, and read the result
+// back through a pipe.  Falls back to running in-process.
+static int runIsolated(const Dialect *d, const CorpusShape *shape, const char *mode, size_t size, int runs,
+                       BenchResult *r) {
+#ifndef _WIN32
+    int fds[2];
+    fflush(NULL);
+    if (pipe(fds) == 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            runCase(d, shape, mode, size, runs, r);
+            ssize_t n = write(fds[1], r, sizeof(*r));
+            _exit(n == (ssize_t)sizeof(*r) ? 0 : 1);
+        }
+        close(fds[1]);
+        if (pid > 0) {
+            ssize_t n = read(fds[0], r, sizeof(*r));
+            int status;
+            waitpid(pid, &status, 0);
+            close(fds[0]);
+            // The string fields point into static tables, the same in the child.
+            return n == (ssize_t)sizeof(*r) ? 0 : -1;
+        }
+        close(fds[0]);
+    }
+#endif
+    runCase(d, shape, mode, size, runs, r);
+    return 0;
+}
+
+/* ---------------------------------------------------------------- output */
+
+static void writeJson(FILE *fp, const BenchResult *r, const char *label) {
+    double mb = r->bytes / 1e6;
+    fprintf(fp,
+            "{\"label\":\"%s\",\"language\":\"%s\",\"corpus\":\"%s\",\"mode\":\"%s\","
+            "\"bytes\":%zu,\"tokens\":%zu,\"seconds\":%.6f,\"mb_per_s\":%.2f,"
+            "\"tokens_per_s\":%.0f,\"ns_per_token\":%.3f,\"peak_rss_kb\":%ld}\n",
+            label, r->language, r->corpus, r->mode, r->bytes, r->tokens, r->seconds,
+            mb / r->seconds, r->tokens / r->seconds, r->seconds * 1e9 / r->tokens, r->peakRssKb);
+}
+
+typedef struct {
+    char key[96];            // language/corpus/mode
+    double nsPerToken;
+} BaselineEntry;
+
+typedef struct {
+    BaselineEntry *items;
+    size_t count;
+} Baseline;
+
+// Copy the string value of "name" in a JSON line written by writeJson.
+static int jsonString(const char *line, const char *name, char *out, size_t size) {
+    char pattern[48];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", name);
+    const char *p = strstr(line, pattern);
+    if (!p)
+        return -1;
+    p += strlen(pattern);
+    size_t n = strcspn(p, "\"");
+    if (n >= size)
+        return -1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return 0;
+}
+
+static int jsonNumber(const char *line, const char *name, double *out) {
+    char pattern[48];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", name);
+    const char *p = strstr(line, pattern);
+    return p && sscanf(p + strlen(pattern), "%lf", out) == 1 ? 0 : -1;
+}
+
+// Later lines for the same case replace earlier ones, so a file appended
+// to across commits compares against its last run.
+static int loadBaseline(Baseline *b, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+        char language[24], corpus[24], mode[24];
+        double ns;
+        if (jsonString(line, "language", language, sizeof(language)) != 0 ||
+            jsonString(line, "corpus", corpus, sizeof(corpus)) != 0 ||
+            jsonString(line, "mode", mode, sizeof(mode)) != 0 || jsonNumber(line, "ns_per_token", &ns) != 0)
+            continue;
+        char key[96];
+        snprintf(key, sizeof(key), "%s/%s/%s", language, corpus, mode);
+        size_t i;
+        for (i = 0; i < b->count && strcmp(b->items[i].key, key) != 0; i++)
+            ;
+        if (i == b->count) {
+            BaselineEntry *items = realloc(b->items, (b->count + 1) * sizeof(BaselineEntry));
+            if (!items)
+                break;
+            b->items = items;
+            strcpy(b->items[b->count++].key, key);
+        }
+        b->items[i].nsPerToken = ns;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static const BaselineEntry *findBaseline(const Baseline *b, const BenchResult *r) {
+    char key[96];
+    snprintf(key, sizeof(key), "%s/%s/%s", r->language, r->corpus, r->mode);
+    for (size_t i = 0; i < b->count; i++) {
+        if (strcmp(b->items[i].key, key) == 0)
+            return &b->items[i];
+    }
+    return NULL;
+}
+
+static void printRow(const BenchResult *r, const Baseline *baseline) {
+    char rss[24], change[24] = "";
+    if (r->peakRssKb >= 0)
+        snprintf(rss, sizeof(rss), "%.1f", r->peakRssKb / 1024.0);
+    else
+        strcpy(rss, "n/a");
+    const BaselineEntry *old = baseline ? findBaseline(baseline, r) : NULL;
+    double ns = r->seconds * 1e9 / r->tokens;
+    if (old && old->nsPerToken > 0)
+        snprintf(change, sizeof(change), "%+.1f%%", (ns - old->nsPerToken) * 100.0 / old->nsPerToken);
+    printf("%-11s %-10s %-8s %10zu %9.1f %12.0f %9.2f %9s %8s\n", r->language, r->corpus, r->mode,
+           r->tokens, r->bytes / 1e6 / r->seconds, r->tokens / r->seconds, ns, rss, change);
+    fflush(stdout);
+}
+
+static int saveCorpus(const char *dir, const Dialect *d, const CorpusShape *shape, size_t size) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s_%s%s", dir, shape->name, d->name, d->ext);
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+        return -1;
+    Corpus corpus;
+    generateCorpus(&corpus, d, shape, size);
+    size_t written = fwrite(corpus.data, 1, corpus.len, fp);
+    free(corpus.data);
+    return fclose(fp) == 0 && written == corpus.len ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    printf("usage: %s [--size MB] [--runs N] [--lang name] [--corpus name]\n"
+           "       [--json file] [--label text] [--baseline file] [--save-corpus dir]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    double sizeMb = 8;
+    int runs = 5;
+    const char *onlyLang = NULL, *onlyCorpus = NULL, *jsonPath = NULL, *label = "";
+    const char *baselinePath = NULL, *corpusDir = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i], *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--size") == 0)
+            sizeMb = atof(value);
+        else if (strcmp(arg, "--runs") == 0)
+            runs = atoi(value);
+        else if (strcmp(arg, "--lang") == 0)
+            onlyLang = value;
+        else if (strcmp(arg, "--corpus") == 0)
+            onlyCorpus = value;
+        else if (strcmp(arg, "--json") == 0)
+            jsonPath = value;
+        else if (strcmp(arg, "--label") == 0)
+            label = value;
+        else if (strcmp(arg, "--baseline") == 0)
+            baselinePath = value;
+        else if (strcmp(arg, "--save-corpus") == 0)
+            corpusDir = value;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (sizeMb <= 0 || runs < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    size_t size = (size_t)(sizeMb * 1024 * 1024);
+
+    Baseline baseline = { NULL, 0 };
+    if (baselinePath && loadBaseline(&baseline, baselinePath) != 0) {
+        printf("Cannot read %s\n", baselinePath);
+        return 1;
+    }
+    FILE *json = NULL;
+    if (jsonPath && !(json = fopen(jsonPath, "a"))) {
+        printf("Cannot open %s\n", jsonPath);
+        return 1;
+    }
+    selectScanKernels();
+
+    printf("%-11s %-10s %-8s %10s %9s %12s %9s %9s %8s\n", "Language", "Corpus", "Mode", "tokens",
+           "MB/s", "tokens/s", "ns/token", "peak MB", baselinePath ? "vs base" : "");
+    int matched = 0;
+    for (size_t l = 0; l < NUM_DIALECTS; l++) {
+        const Dialect *d = &dialects[l];
+        if (onlyLang && strcmp(onlyLang, d->name) != 0)
+            continue;
+        for (size_t s = 0; s < NUM_SHAPES; s++) {
+            const CorpusShape *shape = &shapes[s];
+            if (onlyCorpus && strcmp(onlyCorpus, shape->name) != 0)
+                continue;
+            matched++;
+            if (corpusDir && saveCorpus(corpusDir, d, shape, size) != 0)
+                printf("Cannot write %s corpus to %s\n", shape->name, corpusDir);
+            static const char *const modes[] = { "tokens", "symbols" };
+            for (int m = 0; m < 2; m++) {
+                BenchResult r;
+                if (runIsolated(d, shape, modes[m], size, runs, &r) != 0) {
+                    printf("%-11s %-10s %-8s failed\n", d->name, shape->name, modes[m]);
+                    continue;
+                }
+                printRow(&r, baselinePath ? &baseline : NULL);
+                if (json)
+                    writeJson(json, &r, label);
+            }
+        }
+    }
+    if (json)
+        fclose(json);
+    free(baseline.items);
+    if (!matched) {
+        printf("No language/corpus matches\n");
+        return 1;
+    }
+    return 0;
+}
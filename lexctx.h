@@ -0,0 +1,96 @@
+#ifndef LEXCTX_H
+#define LEXCTX_H
+
+/*
+ * Lexer context: everything one lexing session changes as it runs.
+ *
+ *   src       the input; src->pos is the cursor
+ *   row, col  position of the next token
+ *   symbols   declarations found so far
+ *   strings   the pool names and types are interned in; its arena is the
+ *             session's allocator for strings
+ *   scratch   an arena for working memory of one file (token windows);
+ *             a pass marks it, allocates from it, and releases the lot
+ *             when the file is done, so steady-state files need no malloc
+ *
+ * getNextToken, the collectors, generateSymbolTable and the drivers built
+ * on them take the context as their first argument and touch nothing else
+ * but read-only language tables, so any number of sessions can be live in
+ * one process, on one thread or many, without locks.  A context is used by
+ * one thread at a time.
+ */
+
+#include <string.h>
+#include "srcbuf.h"
+#include "symtab.h"
+
+typedef struct LexerContext LexerContext;
+
+struct LexerContext {
+    SourceBuffer *src;
+    int row, col;
+    SymbolTable symbols;
+    Interner strings;
+    Arena scratch;
+
+    // When set, addSymbol hands declarations to this instead of the table;
+    // the incremental driver (relex.h) and scoped tables (scope.h) use it
+    // to see which tokens declare what.  hookData is theirs.
+    void (*declarationHook)(LexerContext *ctx, unsigned nameId, const char *declType);
+    void *hookData;
+};
+
+static void initLexerContext(LexerContext *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->row = 1;
+    ctx->col = 1;
+}
+
+// Start lexing src from its beginning.
+static void beginLexing(LexerContext *ctx, SourceBuffer *src) {
+    ctx->src = src;
+    srcRewind(src);
+    ctx->row = 1;
+    ctx->col = 1;
+}
+
+SymbolTableEntry *lookupSymbol(LexerContext *ctx, const char *name) {
+    unsigned id = findInterned(&ctx->strings, name, strlen(name));
+    if (!id || id >= ctx->symbols.idCapacity || !ctx->symbols.byId[id])
+        return NULL;
+    return &ctx->symbols.entries[ctx->symbols.byId[id] - 1];
+}
+
+// Add a declaration of the interned name nameId; type must stay valid as
+// long as the table (a literal or a string from ctx->strings).
+void addSymbol(LexerContext *ctx, unsigned nameId, const char *declType) {
+    int added;
+    if (!nameId)
+        return;
+    if (ctx->declarationHook) {
+        ctx->declarationHook(ctx, nameId, declType);
+        return;
+    }
+    int idx = internSymbol(&ctx->symbols, nameId, &added);
+    LEXSTATS(lexStats.declarations++; lexStats.duplicates += !added;)
+
+    // Avoid duplicate entries: the first declaration wins.
+    if (idx < 0 || !added)
+        return;
+    fillSymbolEntry(&ctx->symbols.entries[idx], nameId, internedString(&ctx->strings, nameId), declType);
+}
+
+void addToSymbolTable(LexerContext *ctx, const char *name, const char *declType) {
+    addSymbol(ctx, internString(&ctx->strings, name, strlen(name)), intern(&ctx->strings, declType));
+}
+
+// Free the symbol table, the strings and the scratch arena; the context
+// can be used again.
+static void freeLexerContext(LexerContext *ctx) {
+    freeSymbolTable(&ctx->symbols);
+    freeInterner(&ctx->strings);
+    freeArena(&ctx->scratch);
+    initLexerContext(ctx);
+}
+
+#endif
@@ -0,0 +1,620 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+/*
+ * Shared lexer core used by all six front ends (javascript.c, csample.c,
+ * java.c, csharp.c, ruby.c, perl.c).
+ *
+ * The scanners only differed in comment syntax, which extra characters may
+ * appear in identifiers, the keyword list and a few output details; those
+ * now live in a LanguageDescriptor (see languages.h) and everything else is
+ * written once here.  Build a front end with e.g. `gcc -O2 -pthread java.c -o java`.
+ *
+ * The scanner keeps no state of its own: the input, position and symbol
+ * table of a run are in the LexerContext (lexctx.h) every call is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "srcbuf.h"
+#include "lexctx.h"
+#include "simdscan.h"
+#include "toklist.h"
+
+// Bump whenever a change alters the tokens or symbols any language produces;
+// it is part of the symbol cache key (symcache.h).
+#define LEXER_VERSION 2
+
+typedef struct {
+    int row, col;
+    int kind;        // TOKEN_*
+    int length;
+    size_t offset;   // lexeme is an (offset, length) view into the source buffer
+} Token;
+
+/*
+ * The scanner is a table-driven DFA.  Every input byte is mapped to a
+ * character class through a 256-entry table, and the (state, class) pair
+ * selects a transition: the next state plus a set of actions (count a
+ * column, start a new line, mark the lexeme start, accept the token with or
+ * without the current byte).  Both tables are built once per language from
+ * its descriptor by initLexTables().
+ */
+
+enum {
+    LEX_START,        // between tokens
+    LEX_SLASH,        // saw the first character of a two-character comment marker
+    LEX_COMMENT,      // inside a line comment
+    LEX_DQ_STRING,    // inside "..."
+    LEX_SQ_STRING,    // inside '...'
+    LEX_NUMBER,
+    LEX_IDENT,
+    LEX_OPERATOR_EQ,  // saw one of = ! < > and may still take a trailing '='
+    LEX_BLOCK,        // inside /* ... */
+    LEX_BLOCK_STAR,   // inside /* ... */ just after a '*'
+    LEX_DIRECTIVE,    // inside a preprocessor line
+    LEX_DIR_ESCAPE,   // after a '\' in one, which may continue it on the next line
+    LEX_DIR_SLASH,    // after a '/' in one
+    LEX_DIR_BLOCK,    // inside a /* ... */ that started in one
+    LEX_DIR_STAR,     // the same just after a '*'
+    LEX_NUM_STATES
+};
+
+enum {
+    LEX_CC_SPACE,
+    LEX_CC_NEWLINE,
+    LEX_CC_DIGIT,
+    LEX_CC_IDENT,     // letters, '_' and the language's extra identifier characters
+    LEX_CC_DQUOTE,
+    LEX_CC_SQUOTE,
+    LEX_CC_COMMENT,   // first character of the line comment marker
+    LEX_CC_EQUALS,    // '=' when two-character operators are enabled
+    LEX_CC_OPERATOR_EQ,  // '!', '<', '>' when two-character operators are enabled
+    LEX_CC_OPERATOR,
+    LEX_CC_STAR,      // '*' when block comments are enabled
+    LEX_CC_HASH,      // '#' when directives are enabled
+    LEX_CC_BACKSLASH, // '\' when directives are enabled
+    LEX_CC_OTHER,
+    LEX_CC_EOF,
+    LEX_NUM_CLASSES
+};
+
+enum {
+    LEX_ACT_COL = 1,       // col++
+    LEX_ACT_LINE = 2,      // row++, col = 1
+    LEX_ACT_BEGIN = 4,     // the lexeme starts at this byte
+    LEX_ACT_ACCEPT = 8,    // token ends after this byte
+    LEX_ACT_RETRACT = 16   // token ends before this byte; push it back
+};
+
+enum {
+    LEX_KIND_STRING,
+    LEX_KIND_NUMBER,
+    LEX_KIND_IDENT,        // refined into keyword / variable / id after the scan
+    LEX_KIND_OPERATOR,
+    LEX_KIND_UNKNOWN,
+    LEX_KIND_DIRECTIVE,
+    LEX_KIND_EOF
+};
+
+typedef struct {
+    unsigned char next;    // state to continue in
+    unsigned char action;  // LEX_ACT_* flags
+    unsigned char kind;    // LEX_KIND_* when the transition accepts or retracts
+    unsigned char pad;     // keeps entries 4 bytes wide for cheaper indexing
+} LexTransition;
+
+typedef struct {
+    atomic_int ready;
+    unsigned char charClass[256];
+    LexTransition transitions[LEX_NUM_STATES][LEX_NUM_CLASSES];
+} LexTables;
+
+typedef struct LanguageDescriptor LanguageDescriptor;
+typedef struct TokenBuffer TokenBuffer;
+
+struct LanguageDescriptor {
+    const char *name;
+    const char *lineComment;     // "//" or "#"
+    const char *identChars;      // allowed in identifiers besides letters, digits and '_'
+    const char *variableSigils;  // identifiers starting with one of these are typed "variable"
+    const char *const *keywords;
+    int numKeywords;
+    int (*keywordIndex)(const char *s, int len);  // generated perfect hash, see keywords.h
+    int twoCharOperators;        // recognise ==, !=, <= and >=
+    int blockComments;           // skip /* ... */ too, and lex a lone '/' as an operator (lineComment "//")
+    int directives;              // '#' starts a preprocessor line, lexed as one TOKEN_DIRECTIVE
+    LexTables *tables;           // filled in by initLexTables()
+
+    // Records the declarations that start at tokens [begin, end) of
+    // ctx->src with addSymbol.  May read one token past end as lookahead;
+    // returns the first index it did not consume, so a caller feeding
+    // windows of tokens knows where to resume.
+    size_t (*collectSymbols)(LexerContext *ctx, const LanguageDescriptor *lang, const TokenBuffer *tokens,
+                             size_t begin, size_t end);
+
+    // +1 if token i opens a block scope, -1 if it closes one, else 0 (see
+    // scope.h).  NULL means braces.  Called once per token in order; *state
+    // starts at 0 for each file and is the function's to use.
+    int (*scopeDelta)(const SourceBuffer *src, const TokenBuffer *tokens, size_t i, size_t *state);
+
+    const char *tableTitle;      // heading printed above the symbol table
+    int showIndex;               // print the entry index instead of its hash
+    const char *extensions;      // space-separated suffixes picked up from directories in batch mode
+};
+
+static void setTransition(LexTables *t, int state, int cls, int next, int action, int kind) {
+    t->transitions[state][cls].next = (unsigned char)next;
+    t->transitions[state][cls].action = (unsigned char)action;
+    t->transitions[state][cls].kind = (unsigned char)kind;
+}
+
+// Transitions for the first byte of a token.  From LEX_START the byte has
+// already been counted as a column; the byte after a lone '/' has not, and
+// whitespace there becomes an unknown token, as in the original scanners
+// (languages with block comments instead make the '/' an operator; see
+// setBlockComments).
+static void setTokenStarts(LexTables *t, const LanguageDescriptor *lang, int state, int count) {
+    int begin = LEX_ACT_BEGIN | count;
+    for (int cls = 0; cls < LEX_NUM_CLASSES; cls++)
+        setTransition(t, state, cls, LEX_START, begin | LEX_ACT_ACCEPT, LEX_KIND_UNKNOWN);
+    setTransition(t, state, LEX_CC_DIGIT, LEX_NUMBER, begin, 0);
+    setTransition(t, state, LEX_CC_IDENT, LEX_IDENT, begin, 0);
+    setTransition(t, state, LEX_CC_DQUOTE, LEX_DQ_STRING, begin, 0);
+    setTransition(t, state, LEX_CC_SQUOTE, LEX_SQ_STRING, begin, 0);
+    setTransition(t, state, LEX_CC_EQUALS, LEX_OPERATOR_EQ, begin, 0);
+    setTransition(t, state, LEX_CC_OPERATOR_EQ, LEX_OPERATOR_EQ, begin, 0);
+    setTransition(t, state, LEX_CC_OPERATOR, LEX_START, begin | LEX_ACT_ACCEPT, LEX_KIND_OPERATOR);
+    setTransition(t, state, LEX_CC_STAR, LEX_START, begin | LEX_ACT_ACCEPT, LEX_KIND_OPERATOR);
+    setTransition(t, state, LEX_CC_HASH, LEX_DIRECTIVE, begin, 0);
+    setTransition(t, state, LEX_CC_EOF, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_EOF);
+    if (state == LEX_START) {
+        setTransition(t, state, LEX_CC_SPACE, LEX_START, LEX_ACT_COL, 0);
+        setTransition(t, state, LEX_CC_NEWLINE, LEX_START, LEX_ACT_LINE, 0);
+        setTransition(t, state, LEX_CC_COMMENT,
+                      lang->lineComment[1] != '\0' ? LEX_SLASH : LEX_COMMENT, LEX_ACT_COL, 0);
+    } else {
+        setTransition(t, state, LEX_CC_COMMENT, LEX_COMMENT, 0, 0);
+    }
+}
+
+// C comments.  A '/' begins its token, so when the next byte is neither
+// '/' nor '*' it can be retracted as an operator.  Every byte of a block
+// comment counts a column and every newline a row, so positions after it
+// are right.
+static void setBlockComments(LexTables *t) {
+    setTransition(t, LEX_START, LEX_CC_COMMENT, LEX_SLASH, LEX_ACT_BEGIN | LEX_ACT_COL, 0);
+    for (int cls = 0; cls < LEX_NUM_CLASSES; cls++) {
+        setTransition(t, LEX_SLASH, cls, LEX_START, LEX_ACT_RETRACT, LEX_KIND_OPERATOR);
+        setTransition(t, LEX_BLOCK, cls, LEX_BLOCK, LEX_ACT_COL, 0);
+        setTransition(t, LEX_BLOCK_STAR, cls, LEX_BLOCK, LEX_ACT_COL, 0);
+    }
+    setTransition(t, LEX_SLASH, LEX_CC_COMMENT, LEX_COMMENT, 0, 0);
+    setTransition(t, LEX_SLASH, LEX_CC_STAR, LEX_BLOCK, LEX_ACT_COL, 0);
+    setTransition(t, LEX_BLOCK, LEX_CC_NEWLINE, LEX_BLOCK, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_BLOCK, LEX_CC_STAR, LEX_BLOCK_STAR, LEX_ACT_COL, 0);
+    setTransition(t, LEX_BLOCK_STAR, LEX_CC_NEWLINE, LEX_BLOCK, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_BLOCK_STAR, LEX_CC_STAR, LEX_BLOCK_STAR, LEX_ACT_COL, 0);
+    setTransition(t, LEX_BLOCK_STAR, LEX_CC_COMMENT, LEX_START, LEX_ACT_COL, 0);
+    setTransition(t, LEX_BLOCK, LEX_CC_EOF, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_EOF);
+    setTransition(t, LEX_BLOCK_STAR, LEX_CC_EOF, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_EOF);
+}
+
+/*
+ * Preprocessor lines.  A '#' outside strings and comments only ever starts
+ * a directive in C ('#' and '##' in macro bodies are inside one), so from
+ * there to the end of the line is one token.  A backslash before the
+ * newline (trailing blanks allowed) continues it, and so does a block
+ * comment that runs onto the next line.  The newline is left for the next
+ * token.
+ */
+static void setDirectives(LexTables *t) {
+    for (int cls = 0; cls < LEX_NUM_CLASSES; cls++) {
+        setTransition(t, LEX_DIRECTIVE, cls, LEX_DIRECTIVE, LEX_ACT_COL, 0);
+        setTransition(t, LEX_DIR_ESCAPE, cls, LEX_DIRECTIVE, LEX_ACT_COL, 0);
+        setTransition(t, LEX_DIR_SLASH, cls, LEX_DIRECTIVE, LEX_ACT_COL, 0);
+        setTransition(t, LEX_DIR_BLOCK, cls, LEX_DIR_BLOCK, LEX_ACT_COL, 0);
+        setTransition(t, LEX_DIR_STAR, cls, LEX_DIR_BLOCK, LEX_ACT_COL, 0);
+    }
+    static const unsigned char lineStates[] = { LEX_DIRECTIVE, LEX_DIR_ESCAPE, LEX_DIR_SLASH };
+    for (int k = 0; k < 3; k++) {
+        setTransition(t, lineStates[k], LEX_CC_NEWLINE, LEX_START, LEX_ACT_RETRACT, LEX_KIND_DIRECTIVE);
+        setTransition(t, lineStates[k], LEX_CC_BACKSLASH, LEX_DIR_ESCAPE, LEX_ACT_COL, 0);
+    }
+    setTransition(t, LEX_DIRECTIVE, LEX_CC_COMMENT, LEX_DIR_SLASH, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_ESCAPE, LEX_CC_SPACE, LEX_DIR_ESCAPE, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_ESCAPE, LEX_CC_NEWLINE, LEX_DIRECTIVE, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_DIR_SLASH, LEX_CC_COMMENT, LEX_DIRECTIVE, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_SLASH, LEX_CC_STAR, LEX_DIR_BLOCK, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_BLOCK, LEX_CC_NEWLINE, LEX_DIR_BLOCK, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_DIR_BLOCK, LEX_CC_STAR, LEX_DIR_STAR, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_STAR, LEX_CC_NEWLINE, LEX_DIR_BLOCK, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_DIR_STAR, LEX_CC_STAR, LEX_DIR_STAR, LEX_ACT_COL, 0);
+    setTransition(t, LEX_DIR_STAR, LEX_CC_COMMENT, LEX_DIRECTIVE, LEX_ACT_COL, 0);
+    for (int s = LEX_DIRECTIVE; s <= LEX_DIR_STAR; s++)
+        setTransition(t, s, LEX_CC_EOF, LEX_START, LEX_ACT_RETRACT, LEX_KIND_DIRECTIVE);
+}
+
+void initLexTables(const LanguageDescriptor *lang) {
+    LexTables *t = lang->tables;
+    unsigned char *cc = t->charClass;
+
+    // Lowest precedence first, so later assignments win in the same order
+    // the original scanners tested them: whitespace, comment, string,
+    // number, identifier, operator.  NUL matched the terminator in the old
+    // strchr() operator test, so it scans as an operator too.
+    memset(cc, LEX_CC_OTHER, 256);
+    for (const char *p = "+-*/=%;:,(){}[].<>!"; *p; p++)
+        cc[(unsigned char)*p] = LEX_CC_OPERATOR;
+    cc[0] = LEX_CC_OPERATOR;
+    if (lang->twoCharOperators) {
+        cc['='] = LEX_CC_EQUALS;
+        cc['!'] = cc['<'] = cc['>'] = LEX_CC_OPERATOR_EQ;
+    }
+    for (int c = 'a'; c <= 'z'; c++)
+        cc[c] = cc[c - 'a' + 'A'] = LEX_CC_IDENT;
+    cc['_'] = LEX_CC_IDENT;
+    for (const char *p = lang->identChars; *p; p++)
+        cc[(unsigned char)*p] = LEX_CC_IDENT;
+    for (int c = '0'; c <= '9'; c++)
+        cc[c] = LEX_CC_DIGIT;
+    cc['"'] = LEX_CC_DQUOTE;
+    cc['\''] = LEX_CC_SQUOTE;
+    if (lang->blockComments)
+        cc['*'] = LEX_CC_STAR;
+    if (lang->directives) {
+        cc['#'] = LEX_CC_HASH;
+        cc['\\'] = LEX_CC_BACKSLASH;
+    }
+    cc[(unsigned char)lang->lineComment[0]] = LEX_CC_COMMENT;
+    cc[' '] = cc['\t'] = cc['\v'] = cc['\f'] = cc['\r'] = LEX_CC_SPACE;
+    cc['\n'] = LEX_CC_NEWLINE;
+
+    setTokenStarts(t, lang, LEX_START, LEX_ACT_COL);
+    setTokenStarts(t, lang, LEX_SLASH, 0);
+
+    for (int cls = 0; cls < LEX_NUM_CLASSES; cls++) {
+        setTransition(t, LEX_COMMENT, cls, LEX_COMMENT, 0, 0);
+        setTransition(t, LEX_DQ_STRING, cls, LEX_DQ_STRING, LEX_ACT_COL, 0);
+        setTransition(t, LEX_SQ_STRING, cls, LEX_SQ_STRING, LEX_ACT_COL, 0);
+        setTransition(t, LEX_NUMBER, cls, LEX_START, LEX_ACT_RETRACT, LEX_KIND_NUMBER);
+        setTransition(t, LEX_IDENT, cls, LEX_START, LEX_ACT_RETRACT, LEX_KIND_IDENT);
+        setTransition(t, LEX_OPERATOR_EQ, cls, LEX_START, LEX_ACT_RETRACT, LEX_KIND_OPERATOR);
+    }
+    setTransition(t, LEX_COMMENT, LEX_CC_NEWLINE, LEX_START, LEX_ACT_LINE, 0);
+    setTransition(t, LEX_COMMENT, LEX_CC_EOF, LEX_START, LEX_ACT_LINE | LEX_ACT_ACCEPT, LEX_KIND_EOF);
+    setTransition(t, LEX_DQ_STRING, LEX_CC_DQUOTE, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_STRING);
+    setTransition(t, LEX_DQ_STRING, LEX_CC_EOF, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_STRING);
+    setTransition(t, LEX_SQ_STRING, LEX_CC_SQUOTE, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_STRING);
+    setTransition(t, LEX_SQ_STRING, LEX_CC_EOF, LEX_START, LEX_ACT_ACCEPT, LEX_KIND_STRING);
+    setTransition(t, LEX_NUMBER, LEX_CC_DIGIT, LEX_NUMBER, LEX_ACT_COL, 0);
+    setTransition(t, LEX_IDENT, LEX_CC_DIGIT, LEX_IDENT, LEX_ACT_COL, 0);
+    setTransition(t, LEX_IDENT, LEX_CC_IDENT, LEX_IDENT, LEX_ACT_COL, 0);
+    setTransition(t, LEX_OPERATOR_EQ, LEX_CC_EQUALS, LEX_START,
+                  LEX_ACT_COL | LEX_ACT_ACCEPT, LEX_KIND_OPERATOR);
+    if (lang->blockComments)
+        setBlockComments(t);
+    if (lang->directives)
+        setDirectives(t);
+
+    atomic_store_explicit(&t->ready, 1, memory_order_release);
+}
+
+// Build lang's tables the first time any session lexes it.  Sessions on
+// several threads can get here at once; the lock lets one of them do it.
+static void prepareLexTables(const LanguageDescriptor *lang) {
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&lock);
+    if (!atomic_load_explicit(&lang->tables->ready, memory_order_relaxed))
+        initLexTables(lang);
+    pthread_mutex_unlock(&lock);
+}
+
+static inline int isKeyword(const LanguageDescriptor *lang, const SourceBuffer *src, const Token *token) {
+    LEXSTATS(uint64_t start = lexTicks();)
+    int found = lang->keywordIndex(src->data + token->offset, token->length) >= 0;
+    LEXSTATS(lexStats.keywordLookups++; lexStats.keywordHits += found;
+             lexHistogramAdd(&lexStats.keywordTicks, lexTicks() - start);)
+    return found;
+}
+
+/*
+ * A scan of one token that can stop where the buffered input ends and go
+ * on once more has been appended (stream.h), so a long comment, string or
+ * run of whitespace split across reads is only scanned once.  state is the
+ * DFA state to continue in and token the row, col and start found so far.
+ */
+typedef struct {
+    int state;
+    Token token;
+} TokenScan;
+
+// scanToken is specialised into each caller (getNextToken scans with more
+// constant 0), which only happens if it is inlined there.
+#if defined(__GNUC__)
+#define LEX_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LEX_ALWAYS_INLINE __forceinline
+#else
+#define LEX_ALWAYS_INLINE inline
+#endif
+
+// Start scanning a token at ctx->src's cursor.
+static inline void beginTokenScan(LexerContext *ctx, TokenScan *scan) {
+    scan->state = LEX_START;
+    scan->token.row = ctx->row;
+    scan->token.col = ctx->col;
+    scan->token.offset = ctx->src->pos;
+}
+
+/*
+ * Run scan on from ctx->src's cursor and move past what it reads.  Returns
+ * 1 with scan->token complete.  With more set, the end of the buffer is
+ * not the end of the input: the scan stops there and returns 0, ready to
+ * be continued after the buffer has grown.  A scan that stops between
+ * tokens (in whitespace or a comment) moves token.offset up to the cursor,
+ * so everything before token.offset may be dropped while it waits.
+ */
+static LEX_ALWAYS_INLINE int scanToken(LexerContext *ctx, const LanguageDescriptor *lang, TokenScan *scan, int more) {
+    const LexTables *tables = lang->tables;
+    if (!atomic_load_explicit(&tables->ready, memory_order_acquire))
+        prepareLexTables(lang);
+
+    // Work on local copies so the loop does not store to the context (or
+    // reload it) after every byte.
+    SourceBuffer *src = ctx->src;
+    const unsigned char *data = (const unsigned char *)src->data;
+    size_t pos = src->pos, len = src->len;
+    int curRow = ctx->row, curCol = ctx->col;
+    LEXSTATS(uint64_t start = lexTicks();)
+    Token token = scan->token;
+
+    int state = scan->state, kind;
+    for (;;) {
+        int cls;
+        if (pos < len) {
+            cls = tables->charClass[data[pos++]];
+        } else if (more) {
+            src->pos = pos;
+            ctx->row = curRow;
+            ctx->col = curCol;
+            if (state == LEX_START || state == LEX_COMMENT || state == LEX_BLOCK || state == LEX_BLOCK_STAR)
+                token.offset = pos;
+            scan->state = state;
+            scan->token = token;
+            return 0;
+        } else {
+            cls = LEX_CC_EOF;
+        }
+        const LexTransition *t = &tables->transitions[state][cls];
+        int action = t->action;
+
+        // Whitespace, comment bodies and string bodies can run for many
+        // bytes; hand those to the bulk kernels in simdscan.h.
+        if (state == LEX_START && cls <= LEX_CC_NEWLINE) {
+            LexLines lines = { 0, 0 };
+            size_t n = lexSkipSpace(data + pos - 1, len - pos + 1, &lines);
+            if (lines.count) {
+                curRow += lines.count;
+                curCol = 1 + (int)(n - 1 - lines.last);
+            } else {
+                curCol += (int)n;
+            }
+            pos += n - 1;
+            LEXSTATS(lexStats.spaceBytes += n;)
+            continue;
+        }
+        if (state == LEX_COMMENT && action == 0 && t->next == state) {
+            size_t n = lexFindByte(data + pos, len - pos, '\n');
+            pos += n;
+            LEXSTATS(lexStats.commentBytes += n + 1;)
+            continue;
+        }
+        if (state == LEX_BLOCK && t->next == state) {
+            LexLines lines = { 0, 0 };
+            size_t n = lexFindCommentEnd(data + pos - 1, len - pos + 1, &lines);
+            if (lines.count) {
+                curRow += lines.count;
+                curCol = 1 + (int)(n - 1 - lines.last);
+            } else {
+                curCol += (int)n;
+            }
+            pos += n - 1;
+            LEXSTATS(lexStats.commentBytes += n;)
+            continue;
+        }
+        if ((state == LEX_DQ_STRING || state == LEX_SQ_STRING) && t->next == state) {
+            size_t n = lexFindByte(data + pos, len - pos, state == LEX_DQ_STRING ? '"' : '\'');
+            curCol += 1 + (int)n;
+            pos += n;
+            continue;
+        }
+
+        // Most other bytes just extend the current run (identifier or
+        // number); keep that path short.
+        if (action <= LEX_ACT_COL && t->next == state) {
+            const LexTransition *stay = tables->transitions[state];
+            curCol += action;
+            while (pos < len) {
+                t = &stay[tables->charClass[data[pos]]];
+                if (t->action > LEX_ACT_COL || t->next != state)
+                    break;
+                curCol += t->action;
+                pos++;
+            }
+            continue;
+        }
+        if (action & LEX_ACT_COL)
+            curCol++;
+        if (action & LEX_ACT_LINE) {
+            curRow++;
+            curCol = 1;
+        }
+        if (action & LEX_ACT_BEGIN)
+            token.offset = pos - 1;
+        if (action & (LEX_ACT_ACCEPT | LEX_ACT_RETRACT)) {
+            if ((action & LEX_ACT_RETRACT) && cls != LEX_CC_EOF)
+                pos--;
+            kind = t->kind;
+            break;
+        }
+        state = t->next;
+    }
+    src->pos = pos;
+    ctx->row = curRow;
+    ctx->col = curCol;
+
+    if (kind == LEX_KIND_EOF) {
+        token.offset = pos;
+        token.length = 0;
+    } else {
+        token.length = (int)(pos - token.offset);
+    }
+
+    switch (kind) {
+    case LEX_KIND_STRING:   token.kind = TOKEN_STRING; break;
+    case LEX_KIND_NUMBER:   token.kind = TOKEN_NUMBER; break;
+    case LEX_KIND_OPERATOR: token.kind = TOKEN_OPERATOR; break;
+    case LEX_KIND_UNKNOWN:  token.kind = TOKEN_UNKNOWN; break;
+    case LEX_KIND_DIRECTIVE: token.kind = TOKEN_DIRECTIVE; break;
+    case LEX_KIND_EOF:      token.kind = TOKEN_EOF; break;
+    default:
+        // Identifiers, keywords and sigil-prefixed variables.
+        if (isKeyword(lang, src, &token))
+            token.kind = TOKEN_KEYWORD;
+        else if (lang->variableSigils[0] && strchr(lang->variableSigils, src->data[token.offset]) != NULL)
+            token.kind = TOKEN_VARIABLE;
+        else
+            token.kind = TOKEN_ID;
+        break;
+    }
+    LEXSTATS(lexStats.tokens[token.kind]++; lexStats.bytes[token.kind] += (uint64_t)token.length;
+             lexHistogramAdd(&lexStats.tokenTicks[token.kind], lexTicks() - start);)
+    scan->state = LEX_START;
+    scan->token = token;
+    return 1;
+}
+
+// Lex the token at ctx->src's cursor and move past it.
+Token getNextToken(LexerContext *ctx, const LanguageDescriptor *lang) {
+    TokenScan scan;
+    beginTokenScan(ctx, &scan);
+    scanToken(ctx, lang, &scan, 0);
+    return scan.token;
+}
+
+/*
+ * Rows of the symbol listing, written to output in its format (the token
+ * rows are in toklist.h).  Text is exactly what the original printf calls
+ * produced; CSV and JSON Lines carry the same fields.
+ */
+
+// s left-justified in width columns, like printf's %-*s (never truncated).
+static void outPadded(OutputWriter *w, const char *s, size_t width) {
+    size_t n = strlen(s);
+    outBytes(w, s, n);
+    for (; n < width; n++)
+        outChar(w, ' ');
+}
+
+// scoped adds the Scope and Depth columns of scope.h.
+void emitSymbolHeader(const LanguageDescriptor *lang, int scoped) {
+    OutputWriter *w = &output;
+    const char *rule = scoped ? "-------------------------------------------------------------------\n"
+                              : "---------------------------------------------------\n";
+    if (w->format == OUTPUT_TEXT) {
+        outString(w, lang->tableTitle);
+        outChar(w, '\n');
+        outString(w, rule);
+        outString(w, lang->showIndex ? "Index" : "Hash");
+        outString(w, scoped ? "\tName\t\tType\t\tSize\tScope\tDepth\n" : "\tName\t\tType\t\tSize\n");
+        outString(w, rule);
+    } else if (w->format == OUTPUT_CSV) {
+        outString(w, lang->showIndex ? "index" : "hash");
+        outString(w, scoped ? ",name,type,size,scope,depth\n" : ",name,type,size\n");
+    }
+}
+
+// Entry number index of the table; scope < 0 for the flat table.
+void emitSymbol(const LanguageDescriptor *lang, int index, const SymbolTableEntry *entry, int scope, int depth) {
+    OutputWriter *w = &output;
+    int key = lang->showIndex ? index : entry->hash;
+    if (w->format == OUTPUT_TEXT) {
+        outInt(w, key);
+        outChar(w, '\t');
+        outPadded(w, entry->name, 12);
+        outChar(w, '\t');
+        outPadded(w, entry->type, 12);
+        outChar(w, '\t');
+        outString(w, entry->size);
+        if (scope >= 0) {
+            outChar(w, '\t');
+            outInt(w, scope);
+            outChar(w, '\t');
+            outInt(w, depth);
+        }
+        outChar(w, '\n');
+    } else if (w->format == OUTPUT_CSV) {
+        outInt(w, key);
+        outChar(w, ',');
+        outCsvField(w, entry->name, strlen(entry->name));
+        outChar(w, ',');
+        outCsvField(w, entry->type, strlen(entry->type));
+        outChar(w, ',');
+        outCsvField(w, entry->size, strlen(entry->size));
+        if (scope >= 0) {
+            outChar(w, ',');
+            outInt(w, scope);
+            outChar(w, ',');
+            outInt(w, depth);
+        }
+        outChar(w, '\n');
+    } else {
+        outString(w, lang->showIndex ? "{\"index\":" : "{\"hash\":");
+        outInt(w, key);
+        outString(w, ",\"name\":");
+        outJsonString(w, entry->name, strlen(entry->name));
+        outString(w, ",\"type\":");
+        outJsonString(w, entry->type, strlen(entry->type));
+        outString(w, ",\"size\":");
+        outJsonString(w, entry->size, strlen(entry->size));
+        if (scope >= 0) {
+            outString(w, ",\"scope\":");
+            outInt(w, scope);
+            outString(w, ",\"depth\":");
+            outInt(w, depth);
+        }
+        outString(w, "}\n");
+    }
+}
+
+#ifdef LEXER_STATS
+// atexit handler the front ends install in LEXER_STATS builds.
+void reportLexStats(void) {
+    mergeLexStats();
+    printLexStats(stderr, tokenKindNames, TOKEN_NUM_KINDS);
+}
+#endif
+
+void printSymbolTable(const LexerContext *ctx, const LanguageDescriptor *lang) {
+    emitSymbolHeader(lang, 0);
+    for (int i = 0; i < ctx->symbols.count; i++)
+        emitSymbol(lang, i, &ctx->symbols.entries[i], -1, 0);
+}
+
+// Dump the raw token stream as <lexeme, row, col> lines.
+void printTokens(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src) {
+    beginLexing(ctx, src);
+    emitTokenHeader();
+    while (1) {
+        Token token = getNextToken(ctx, lang);
+        if (token.kind == TOKEN_EOF)
+            break;
+        emitToken(token.kind, src->data + token.offset, (size_t)token.length, token.row, token.col);
+    }
+}
+
+#endif
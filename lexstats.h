@@ -0,0 +1,194 @@
+#ifndef LEXSTATS_H
+#define LEXSTATS_H
+
+/*
+ * Optional instrumentation of the lexer and symbol table hot paths.
+ *
+ * Build with -DLEXER_STATS to count, per thread:
+ *
+ *   - tokens and lexeme bytes of each kind, and a histogram of the ticks
+ *     getNextToken spent on each kind
+ *   - whitespace and comment bytes skipped between tokens
+ *   - keyword lookups, hits and their ticks
+ *   - interner probes (how far each lookup walked past its home slot;
+ *     every step is a collision) and scope-chain walk lengths
+ *   - declarations and duplicates reaching addSymbol
+ *   - ticks spent lexing and collecting each generateSymbolTable window
+ *   - arena blocks taken from malloc and from the spare list, bytes handed
+ *     out and released, and object pool gets and recycles (arena.h, scope.h)
+ *
+ * Ticks come from the cheapest cycle counter available (rdtsc on x86,
+ * cntvct on ARM64, otherwise the monotonic clock in ns).  Histograms have
+ * one bucket per power of two.  Worker threads fold their counters into a
+ * process total when they finish, and the front ends print a summary to
+ * stderr at exit.
+ *
+ * Without LEXER_STATS, every LEXSTATS(...) use expands to nothing, so the
+ * hot paths compile exactly as before.
+ */
+
+#ifdef LEXER_STATS
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t lexTicks(void) {
+    return __rdtsc();
+}
+#define LEXSTATS_TICK_UNIT "cycles"
+#elif defined(__aarch64__)
+static inline uint64_t lexTicks(void) {
+    uint64_t t;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+}
+#define LEXSTATS_TICK_UNIT "ticks"
+#else
+#include <time.h>
+static inline uint64_t lexTicks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#define LEXSTATS_TICK_UNIT "ns"
+#endif
+
+#define LEXSTATS(...) __VA_ARGS__
+
+#define LEXSTATS_KINDS 16         // room for every TOKEN_* kind
+#define LEXSTATS_BUCKETS 40       // bucket b counts values in [2^(b-1), 2^b)
+#define LEXSTATS_PROBES 16        // probe lengths past this share the last slot
+
+typedef struct {
+    uint64_t count, sum;
+    uint64_t buckets[LEXSTATS_BUCKETS];
+} LexHistogram;
+
+typedef struct {
+    uint64_t tokens[LEXSTATS_KINDS], bytes[LEXSTATS_KINDS];
+    LexHistogram tokenTicks[LEXSTATS_KINDS];
+    uint64_t spaceBytes, commentBytes;
+    uint64_t keywordLookups, keywordHits;
+    LexHistogram keywordTicks;
+    uint64_t internLookups, internProbes, internMaxProbe;
+    uint64_t internProbeLengths[LEXSTATS_PROBES];
+    uint64_t scopeLookups, scopeSteps;
+    uint64_t declarations, duplicates;
+    uint64_t windows;
+    LexHistogram windowLexTicks, windowCollectTicks;
+    uint64_t arenaBlocks, arenaSpareBlocks, arenaBytes, arenaReleasedBytes;
+    uint64_t poolGets, poolRecycled;
+} LexStats;
+
+THREAD_LOCAL LexStats lexStats;
+
+static LexStats lexStatsTotal;
+static pthread_mutex_t lexStatsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline void lexHistogramAdd(LexHistogram *h, uint64_t value) {
+    int b = value ? 64 - __builtin_clzll(value) : 0;
+    h->buckets[b < LEXSTATS_BUCKETS ? b : LEXSTATS_BUCKETS - 1]++;
+    h->count++;
+    h->sum += value;
+}
+
+static inline void lexStatsProbe(uint64_t probes) {
+    lexStats.internLookups++;
+    lexStats.internProbes += probes;
+    if (probes > lexStats.internMaxProbe)
+        lexStats.internMaxProbe = probes;
+    lexStats.internProbeLengths[probes < LEXSTATS_PROBES ? probes : LEXSTATS_PROBES - 1]++;
+}
+
+// Fold the calling thread's counters into the process total and reset them.
+static void mergeLexStats(void) {
+    const uint64_t *from = (const uint64_t *)&lexStats;
+    uint64_t *to = (uint64_t *)&lexStatsTotal;
+    pthread_mutex_lock(&lexStatsLock);
+    // Everything is a uint64_t sum except the maximum probe length.
+    uint64_t maxProbe = lexStatsTotal.internMaxProbe > lexStats.internMaxProbe ? lexStatsTotal.internMaxProbe
+                                                                               : lexStats.internMaxProbe;
+    for (size_t i = 0; i < sizeof(LexStats) / sizeof(uint64_t); i++)
+        to[i] += from[i];
+    lexStatsTotal.internMaxProbe = maxProbe;
+    pthread_mutex_unlock(&lexStatsLock);
+    memset(&lexStats, 0, sizeof(lexStats));
+}
+
+// Upper bound of the bucket holding the given fraction of the samples.
+static uint64_t lexHistogramQuantile(const LexHistogram *h, double q) {
+    uint64_t want = (uint64_t)(q * (double)h->count), seen = 0;
+    for (int b = 0; b < LEXSTATS_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen > want)
+            return b ? (uint64_t)1 << b : 1;
+    }
+    return UINT64_MAX;
+}
+
+static void printLexHistogram(FILE *fp, const char *label, const LexHistogram *h) {
+    if (!h->count)
+        return;
+    fprintf(fp, "  %-18s n=%-10llu mean %-8.1f p50 <%-6llu p90 <%-6llu p99 <%llu\n", label,
+            (unsigned long long)h->count, (double)h->sum / h->count,
+            (unsigned long long)lexHistogramQuantile(h, 0.5), (unsigned long long)lexHistogramQuantile(h, 0.9),
+            (unsigned long long)lexHistogramQuantile(h, 0.99));
+}
+
+static void printLexStats(FILE *fp, const char *const *kindNames, int kinds) {
+    const LexStats *s = &lexStatsTotal;
+    fprintf(fp, "lexer stats (" LEXSTATS_TICK_UNIT ")\n");
+    fprintf(fp, "  %-10s %12s %14s\n", "kind", "tokens", "bytes");
+    for (int k = 0; k < kinds && k < LEXSTATS_KINDS; k++) {
+        if (s->tokens[k])
+            fprintf(fp, "  %-10s %12llu %14llu\n", kindNames[k], (unsigned long long)s->tokens[k],
+                    (unsigned long long)s->bytes[k]);
+    }
+    fprintf(fp, "  %-10s %12s %14llu\n", "space", "", (unsigned long long)s->spaceBytes);
+    fprintf(fp, "  %-10s %12s %14llu\n", "comment", "", (unsigned long long)s->commentBytes);
+    fprintf(fp, "time per token\n");
+    for (int k = 0; k < kinds && k < LEXSTATS_KINDS; k++)
+        printLexHistogram(fp, kindNames[k], &s->tokenTicks[k]);
+    fprintf(fp, "keywords: %llu lookups, %llu hits\n", (unsigned long long)s->keywordLookups,
+            (unsigned long long)s->keywordHits);
+    printLexHistogram(fp, "lookup", &s->keywordTicks);
+    fprintf(fp, "interner: %llu lookups, %llu collisions, mean probe %.3f, max %llu\n",
+            (unsigned long long)s->internLookups, (unsigned long long)s->internProbes,
+            s->internLookups ? (double)s->internProbes / s->internLookups : 0.0,
+            (unsigned long long)s->internMaxProbe);
+    fprintf(fp, "  probe lengths:");
+    for (int p = 0; p < LEXSTATS_PROBES; p++) {
+        if (s->internProbeLengths[p])
+            fprintf(fp, " %d%s:%llu", p, p == LEXSTATS_PROBES - 1 ? "+" : "",
+                    (unsigned long long)s->internProbeLengths[p]);
+    }
+    fprintf(fp, "\n");
+    if (s->scopeLookups)
+        fprintf(fp, "scopes: %llu lookups, mean chain walk %.3f\n", (unsigned long long)s->scopeLookups,
+                (double)s->scopeSteps / s->scopeLookups);
+    fprintf(fp, "symbols: %llu declarations, %llu duplicates\n", (unsigned long long)s->declarations,
+            (unsigned long long)s->duplicates);
+    if (s->windows) {
+        fprintf(fp, "symbol windows: %llu\n", (unsigned long long)s->windows);
+        printLexHistogram(fp, "lex", &s->windowLexTicks);
+        printLexHistogram(fp, "collect", &s->windowCollectTicks);
+    }
+    fprintf(fp, "allocator: %llu blocks from malloc, %llu from the spare list; %llu bytes allocated, %llu released\n",
+            (unsigned long long)s->arenaBlocks, (unsigned long long)s->arenaSpareBlocks,
+            (unsigned long long)s->arenaBytes, (unsigned long long)s->arenaReleasedBytes);
+    if (s->poolGets)
+        fprintf(fp, "  pool: %llu gets, %llu recycled\n", (unsigned long long)s->poolGets,
+                (unsigned long long)s->poolRecycled);
+}
+
+#else
+
+#define LEXSTATS(...)
+
+#endif
+
+#endif
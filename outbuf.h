@@ -0,0 +1,182 @@
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+/*
+ * Buffered output for the token and symbol listings.
+ *
+ * printf parses its format string on every row, and dumping millions of
+ * tokens spends more time there than in the lexer.  Rows are instead
+ * formatted by hand (integers, padded and quoted fields) into one large
+ * buffer that is handed to write() whenever it fills up.  The buffer is
+ * allocated on first use and reused until the process exits.
+ *
+ * There is one writer, output, shared by everything that prints a
+ * listing; the front end picks its file descriptor and format (text, CSV or
+ * JSON Lines) from the command line.  Only the main thread writes to it.
+ * The row emitters themselves are in toklist.h and lexer.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#else
+#include <unistd.h>
+#endif
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+enum {
+    OUTPUT_TEXT,     // the original tab-separated listings
+    OUTPUT_CSV,
+    OUTPUT_JSONL     // one JSON object per line
+};
+
+typedef struct {
+    int fd;
+    int format;      // OUTPUT_*
+    char *buf;
+    size_t len, capacity;
+    int failed;      // a write failed; later output is dropped
+} OutputWriter;
+
+OutputWriter output = { 1, OUTPUT_TEXT, NULL, 0, 0, 0 };
+
+static void writeAll(OutputWriter *w, const char *data, size_t len) {
+    while (len && !w->failed) {
+        ssize_t n = write(w->fd, data, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            w->failed = 1;
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+void outFlush(OutputWriter *w) {
+    // Keep anything already printf'd to the same descriptor in order.
+    if (w->fd == 1)
+        fflush(stdout);
+    writeAll(w, w->buf, w->len);
+    w->len = 0;
+}
+
+static void outBytesSlow(OutputWriter *w, const char *s, size_t n) {
+    if (!w->buf) {
+        if (!(w->buf = malloc(OUTPUT_BUFFER_SIZE))) {
+            if (w->fd == 1)
+                fflush(stdout);
+            writeAll(w, s, n);
+            return;
+        }
+        w->capacity = OUTPUT_BUFFER_SIZE;
+    }
+    outFlush(w);
+    if (n >= w->capacity) {
+        writeAll(w, s, n);
+        return;
+    }
+    memcpy(w->buf, s, n);
+    w->len = n;
+}
+
+static inline void outBytes(OutputWriter *w, const char *s, size_t n) {
+    if (w->capacity - w->len < n) {
+        outBytesSlow(w, s, n);
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static inline void outChar(OutputWriter *w, char c) {
+    if (w->len == w->capacity) {
+        outBytesSlow(w, &c, 1);
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static inline void outString(OutputWriter *w, const char *s) {
+    outBytes(w, s, strlen(s));
+}
+
+static void outInt(OutputWriter *w, long long v) {
+    char digits[24];
+    int n = 0;
+    unsigned long long u = v < 0 ? 0ull - (unsigned long long)v : (unsigned long long)v;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0)
+        digits[sizeof(digits) - 1 - n++] = '-';
+    outBytes(w, digits + sizeof(digits) - n, (size_t)n);
+}
+
+// A CSV field, quoted only if it needs to be.
+static void outCsvField(OutputWriter *w, const char *s, size_t n) {
+    size_t special = 0;
+    for (size_t i = 0; i < n; i++)
+        special += s[i] == ',' || s[i] == '"' || s[i] == '\n' || s[i] == '\r';
+    if (!special) {
+        outBytes(w, s, n);
+        return;
+    }
+    outChar(w, '"');
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '"')
+            outChar(w, '"');
+        outChar(w, s[i]);
+    }
+    outChar(w, '"');
+}
+
+// A quoted JSON string.  Control bytes are escaped; other bytes are copied
+// as they are, so a lexeme that is not UTF-8 gives a line that is not
+// either.
+static void outJsonString(OutputWriter *w, const char *s, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    outChar(w, '"');
+    size_t run = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        outBytes(w, s + run, i - run);
+        run = i + 1;
+        outChar(w, '\\');
+        if (c == '"' || c == '\\') {
+            outChar(w, (char)c);
+        } else if (c == '\n') {
+            outChar(w, 'n');
+        } else if (c == '\t') {
+            outChar(w, 't');
+        } else {
+            char u[5] = { 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            outBytes(w, u, 5);
+        }
+    }
+    outBytes(w, s + run, n - run);
+    outChar(w, '"');
+}
+
+// Output format named on the command line, or -1.
+static int outputFormat(const char *name) {
+    if (strcmp(name, "text") == 0)
+        return OUTPUT_TEXT;
+    if (strcmp(name, "csv") == 0)
+        return OUTPUT_CSV;
+    if (strcmp(name, "jsonl") == 0)
+        return OUTPUT_JSONL;
+    return -1;
+}
+
+#endif
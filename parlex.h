@@ -0,0 +1,239 @@
+#ifndef PARLEX_H
+#define PARLEX_H
+
+/*
+ * Intra-file parallel lexing for very large inputs.
+ *
+ * The buffer is cut into chunks that start just after a '\n'.  Every chunk
+ * after the first is lexed speculatively on its own thread as if a token
+ * started there at row 1, column 1.  That guess is wrong when the chunk
+ * really begins inside a string or comment (or on a line whose column was
+ * not reset, since strings do not count rows), so a sequential fixup pass
+ * then walks the chunks in order carrying the true (pos, row, col) from
+ * the previous one.  getNextToken's output from a given position depends
+ * only on that position, while row and col are just carried along.  So
+ * the first speculative token whose start position and column equal the
+ * true ones proves the rest of the chunk is right, apart from a constant
+ * row offset.  Up to that point the fixup lexes the real tokens itself,
+ * which is normally a line or less.
+ *
+ * The token stream, including every row and column, is identical to a
+ * sequential run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "lexer.h"
+#include "tokbuf.h"
+
+#define PARLEX_MIN_CHUNK (1 << 20)   // smaller inputs are not worth a thread
+
+typedef struct {
+    Token token;
+    size_t entry;     // src->pos when getNextToken was called
+} LexedToken;
+
+typedef struct {
+    LexedToken *items;
+    size_t count, capacity;
+} LexedTokenList;
+
+static int appendLexedToken(LexedTokenList *list, const Token *token, size_t entry) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        LexedToken *items = realloc(list->items, capacity * sizeof(LexedToken));
+        if (!items)
+            return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].token = *token;
+    list->items[list->count].entry = entry;
+    list->count++;
+    return 0;
+}
+
+static void freeLexedTokens(LexedTokenList *list) {
+    free(list->items);
+    memset(list, 0, sizeof(*list));
+}
+
+typedef struct {
+    size_t begin, end;        // tokens whose entry lies in [begin, end) belong here
+    LexedTokenList tokens;    // speculative, rows relative to the chunk
+    size_t endPos;            // state after the chunk's last token
+    int endRow, endCol;
+    int eof;                  // the chunk's last call returned EOF
+} LexChunk;
+
+typedef struct {
+    const LanguageDescriptor *lang;
+    const SourceBuffer *src;
+    LexChunk *chunks;
+    int numChunks;
+    atomic_int nextChunk;
+} ParallelLex;
+
+// Each chunk gets a context of its own; only its position is used.
+static void lexChunk(const LanguageDescriptor *lang, const SourceBuffer *shared, LexChunk *chunk) {
+    SourceBuffer src = *shared;
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    ctx.src = &src;
+    src.pos = chunk->begin;
+    while (src.pos < chunk->end) {
+        size_t entry = src.pos;
+        Token token = getNextToken(&ctx, lang);
+        if (token.kind == TOKEN_EOF) {
+            chunk->eof = 1;
+            break;
+        }
+        if (appendLexedToken(&chunk->tokens, &token, entry) != 0) {
+            // Out of memory: drop the guess and let the fixup lex it all.
+            freeLexedTokens(&chunk->tokens);
+            break;
+        }
+    }
+    chunk->endPos = src.pos;
+    chunk->endRow = ctx.row;
+    chunk->endCol = ctx.col;
+}
+
+static void *parallelLexWorker(void *arg) {
+    ParallelLex *job = arg;
+    int k;
+    while ((k = atomic_fetch_add(&job->nextChunk, 1)) < job->numChunks)
+        lexChunk(job->lang, job->src, &job->chunks[k]);
+    LEXSTATS(mergeLexStats();)
+    return NULL;
+}
+
+// Split the buffer into up to count chunks of at least minChunk bytes,
+// each ending just after a newline (or at the end of the buffer).
+static int splitChunks(const SourceBuffer *src, LexChunk *chunks, int count, size_t minChunk) {
+    size_t len = src->len, begin = 0;
+    int n = 0;
+    while (begin < len && n < count) {
+        size_t end = len;
+        if (n < count - 1) {
+            size_t target = begin + (len - begin) / (count - n);
+            if (target < begin + minChunk)
+                target = begin + minChunk;
+            if (target < len) {
+                const char *nl = memchr(src->data + target, '\n', len - target);
+                if (nl)
+                    end = (size_t)(nl - src->data) + 1;
+            }
+        }
+        memset(&chunks[n], 0, sizeof(LexChunk));
+        chunks[n].begin = begin;
+        chunks[n].end = end;
+        n++;
+        begin = end;
+    }
+    if (n == 0)
+        memset(&chunks[n++], 0, sizeof(LexChunk));
+    return n;
+}
+
+/*
+ * Tokenise all of src into out on up to jobs threads, in chunks of at
+ * least minChunk bytes, leaving ctx at the end of src as a sequential run
+ * would.  Returns 0, or -1 if out of memory.
+ */
+int lexParallel(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, int jobs, size_t minChunk,
+                TokenBuffer *out) {
+    if (jobs < 1)
+        jobs = 1;
+
+    int maxChunks = jobs * 4;
+    LexChunk *chunks = calloc(maxChunks, sizeof(LexChunk));
+    if (!chunks)
+        return -1;
+    ParallelLex job = { lang, src, chunks, splitChunks(src, chunks, maxChunks, minChunk), 0 };
+
+    int threads = jobs < job.numChunks ? jobs : job.numChunks;
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    int started = 0;
+    for (int i = 1; tids && i < threads; i++) {
+        if (pthread_create(&tids[started], NULL, parallelLexWorker, &job) == 0)
+            started++;
+    }
+    parallelLexWorker(&job);
+    for (int i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+    free(tids);
+
+    // Fixup: stitch the chunks together in order, carrying the true state.
+    // Chunk 0 started at the real beginning, so it syncs on its first token.
+    int status = 0;
+    size_t pos = 0;
+    int curRow = 1, curCol = 1, eof = 0;
+    for (int k = 0; k < job.numChunks && !eof; k++) {
+        LexChunk *chunk = &chunks[k];
+        size_t j = 0;
+        while (pos < chunk->end) {
+            while (j < chunk->tokens.count && chunk->tokens.items[j].entry < pos)
+                j++;
+            if (j < chunk->tokens.count && chunk->tokens.items[j].entry == pos &&
+                chunk->tokens.items[j].token.col == curCol) {
+                int delta = curRow - chunk->tokens.items[j].token.row;
+                for (; j < chunk->tokens.count && status == 0; j++) {
+                    LexedToken *t = &chunk->tokens.items[j];
+                    t->token.row += delta;
+                    status = pushToken(out, &t->token);
+                }
+                pos = chunk->endPos;
+                curRow = chunk->endRow + delta;
+                curCol = chunk->endCol;
+                eof = chunk->eof;
+                break;
+            }
+
+            // Not in step yet: lex the real token here.
+            ctx->src = src;
+            src->pos = pos;
+            ctx->row = curRow;
+            ctx->col = curCol;
+            Token token = getNextToken(ctx, lang);
+            pos = src->pos;
+            curRow = ctx->row;
+            curCol = ctx->col;
+            if (token.kind == TOKEN_EOF) {
+                eof = 1;
+                break;
+            }
+            if (pushToken(out, &token) != 0)
+                status = -1;
+        }
+        freeLexedTokens(&chunk->tokens);
+    }
+    for (int k = 0; k < job.numChunks; k++)
+        freeLexedTokens(&chunks[k].tokens);
+    free(chunks);
+    ctx->src = src;
+    src->pos = pos;
+    ctx->row = curRow;
+    ctx->col = curCol;
+    return status;
+}
+
+// printTokens() for large inputs, lexed on up to jobs threads.
+void printTokensParallel(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, int jobs,
+                         size_t minChunk) {
+    TokenBuffer tokens;
+    initTokenBuffer(&tokens, 1);
+    srcRewind(src);
+    if (lexParallel(ctx, lang, src, jobs, minChunk, &tokens) != 0) {
+        freeTokenBuffer(&tokens);
+        printTokens(ctx, lang, src);
+        return;
+    }
+    printTokenBuffer(src, &tokens);
+    freeTokenBuffer(&tokens);
+}
+
+#endif
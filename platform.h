@@ -0,0 +1,20 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/*
+ * Feature-test macros for the POSIX and BSD interfaces the tree uses
+ * beyond ISO C: strdup, realpath and mkdtemp (POSIX.1-2008), and madvise
+ * and syscall (glibc's default set).  Under -std=gnu* the C library offers
+ * them anyway; under -std=c11 it hides them unless asked, and calls to
+ * them become implicit int declarations.  The macros only count before
+ * the first system header, so every .c file includes this first.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#endif
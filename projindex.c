@@ -0,0 +1,111 @@
+// Project-wide definition index (projindex.h): lexes every file of a
+// project in parallel, whatever its front end, and answers where names are
+// defined.
+//
+//     gcc -O2 -pthread projindex.c -o projindex
+//     ./projindex [--jobs N] [--files-from list] [--query name]... [file | dir]...
+//
+// Directories are walked for the extensions of all the front ends (.js,
+// .c/.h, .java, .cs, .rb, .pl/.pm); each file is lexed by the front end
+// for its extension.  Each --query prints the definitions of that name as
+//
+//     name  type  file:row:col
+//
+// one line per file that declares it, in file-list order.  Without
+// --query the whole index is printed that way, sorted by name.  A summary
+// goes to stderr.  The exit status is 1 if a file could not be read or a
+// queried name has no definition.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "projindex.h"
+
+static void printDefinitions(const ProjectIndex *ix, const Definition *defs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        printf("%-24s %-10s %s:%d:%d\n", defs[i].name, defs[i].type, definitionFile(ix, &defs[i]),
+               defs[i].row, defs[i].col);
+    }
+}
+
+static int nameCompare(const void *a, const void *b) {
+    return strcmp((*(const IndexName *const *)a)->name, (*(const IndexName *const *)b)->name);
+}
+
+static void printIndex(const ProjectIndex *ix) {
+    const IndexName **names = malloc((ix->names ? ix->names : 1) * sizeof(IndexName *));
+    size_t n = 0;
+    if (!names)
+        return;
+    for (int s = 0; s < PROJECT_INDEX_SHARDS; s++) {
+        const IndexShard *shard = &ix->shards[s];
+        for (unsigned slot = 0; shard->names && slot <= shard->mask; slot++) {
+            if (shard->names[slot].name)
+                names[n++] = &shard->names[slot];
+        }
+    }
+    qsort(names, n, sizeof(IndexName *), nameCompare);
+    for (size_t i = 0; i < n; i++) {
+        const IndexShard *shard = &ix->shards[definitionShard(names[i]->hash)];
+        printDefinitions(ix, shard->defs + names[i]->first, names[i]->count);
+    }
+    free(names);
+}
+
+int main(int argc, char *argv[]) {
+    FileList files = { 0 };
+    const char **queries = calloc(argc, sizeof(char *));
+    int numQueries = 0, jobs = defaultJobs();
+
+    char extensions[256] = "";
+    for (size_t i = 0; i < NUM_INDEX_LANGUAGES; i++) {
+        strcat(extensions, " ");
+        strcat(extensions, indexLanguages[i]->extensions);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--query") == 0 && i + 1 < argc) {
+            queries[numQueries++] = argv[++i];
+        } else if (strcmp(argv[i], "--files-from") == 0 && i + 1 < argc) {
+            if (addFilesFrom(&files, argv[++i], extensions) != 0) {
+                printf("Cannot open %s\n", argv[i]);
+                return 1;
+            }
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            printf("usage: %s [--jobs N] [--files-from list] [--query name]... [file | dir]...\n", argv[0]);
+            return 1;
+        } else {
+            addPath(&files, argv[i], extensions);
+        }
+    }
+
+    ProjectIndex ix;
+    int status = buildProjectIndex(&ix, &files, jobs);
+    if (status < 0) {
+        fprintf(stderr, "Out of memory\n");
+        freeProjectIndex(&ix);
+        return 1;
+    }
+
+    if (numQueries == 0)
+        printIndex(&ix);
+    for (int q = 0; q < numQueries; q++) {
+        size_t count;
+        const Definition *defs = findDefinitions(&ix, queries[q], &count);
+        if (count) {
+            printDefinitions(&ix, defs, count);
+        } else {
+            printf("%s: no definition\n", queries[q]);
+            status = 1;
+        }
+    }
+    fprintf(stderr, "%d files indexed, %d failed, %zu definitions of %zu names, %d threads, "
+            "lex %.3f s, merge %.3f s\n", ix.scanned, ix.failed, ix.definitions, ix.names, ix.numWorkers,
+            ix.lexSeconds, ix.mergeSeconds);
+
+    freeProjectIndex(&ix);
+    free(queries);
+    return status ? 1 : 0;
+}
@@ -0,0 +1,393 @@
+#ifndef PROJINDEX_H
+#define PROJINDEX_H
+
+/*
+ * Project index: one table of definitions across all the files of a
+ * project, whatever their languages, answering "where is greet defined".
+ *
+ * It is built in two parallel passes over the file list:
+ *
+ *   1. Lex.  Workers take files off a shared counter and lex each one with
+ *      the front end for its extension.  They record the file's
+ *      declarations (the first per name, as in that file's own symbol
+ *      table) with the row and column of the declaring token.  Each worker
+ *      has its own lexer context and definition list, so the counter is the
+ *      only thing they share.
+ *   2. Merge.  Names are split into PROJECT_INDEX_SHARDS shards by hash, and
+ *      each worker owns every jobs-th shard.  A worker picks its shards'
+ *      definitions out of every worker's list and sorts them by name,
+ *      file, row and col.  It then builds an open-addressed name table per
+ *      shard over the sorted runs.  No two workers write the same shard,
+ *      so the merge takes no locks either.
+ *
+ * Once built, an index is never written again.  findDefinitions is plain
+ * reads: hash the name, pick the shard, probe its table.  It takes no
+ * locks and uses no atomics, so any number of threads can query the
+ * index at once.  The contents do not depend on the number of jobs.
+ * Build with -pthread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "languages.h"
+
+#define PROJECT_INDEX_SHARDS 64   // power of two
+
+// Front ends the index knows, tried in order by extension.
+static const LanguageDescriptor *const indexLanguages[] = {
+    &javascriptLanguage, &cLanguage, &javaLanguage, &csharpLanguage, &rubyLanguage, &perlLanguage,
+};
+
+#define NUM_INDEX_LANGUAGES (sizeof(indexLanguages) / sizeof(indexLanguages[0]))
+
+static const LanguageDescriptor *indexLanguageFor(const char *path) {
+    for (size_t i = 0; i < NUM_INDEX_LANGUAGES; i++) {
+        if (hasExtension(path, indexLanguages[i]->extensions))
+            return indexLanguages[i];
+    }
+    return NULL;
+}
+
+typedef struct {
+    const char *name, *type;   // interned in the pool of the worker that lexed the file
+    int file;                  // position in the file list
+    int row, col;              // of the declaring token
+    unsigned hash;             // hashBytes(name)
+} Definition;
+
+typedef struct {
+    const char *name;          // NULL: empty slot
+    unsigned hash;
+    unsigned first, count;     // run of the shard's definitions
+} IndexName;
+
+typedef struct {
+    const Definition *defs;    // sorted by name, then file, row, col
+    size_t count;
+    IndexName *names;
+    unsigned mask, numNames;
+} IndexShard;
+
+typedef struct ProjectIndex ProjectIndex;
+
+typedef struct {
+    ProjectIndex *index;
+    int id;
+    LexerContext ctx;          // its pool holds the names and types
+    Definition *defs;          // pass 1: what this worker's files declare
+    size_t count, capacity;
+    Definition *merged;        // pass 2: the definitions of this worker's shards
+    size_t mergedCount;
+    // For recordDefinition while a file is collected.
+    const TokenBuffer *tokens;
+    size_t stepToken;
+    int file, stepFailed;
+    int failed;
+    pthread_t thread;
+} IndexWorker;
+
+struct ProjectIndex {
+    FileList files;
+    IndexShard shards[PROJECT_INDEX_SHARDS];
+    IndexWorker *workers;
+    int numWorkers;
+    atomic_int nextFile;
+    int scanned, failed;
+    size_t definitions, names;
+    double lexSeconds, mergeSeconds;
+};
+
+static double indexSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ------------------------------------------------------------- pass 1: lex */
+
+static int appendDefinition(IndexWorker *w, const Definition *def) {
+    if (w->count == w->capacity) {
+        size_t capacity = w->capacity ? w->capacity * 2 : 1024;
+        Definition *defs = realloc(w->defs, capacity * sizeof(Definition));
+        if (!defs)
+            return -1;
+        w->defs = defs;
+        w->capacity = capacity;
+    }
+    w->defs[w->count++] = *def;
+    return 0;
+}
+
+// LexerContext.declarationHook while a file is collected; hookData is the
+// worker.  The collector that made this call started its step at
+// w->stepToken, and every collector declares that token or one just after
+// it, so the declaring token is the first one from there with the name's
+// text.
+static void recordDefinition(LexerContext *ctx, unsigned nameId, const char *declType) {
+    IndexWorker *w = ctx->hookData;
+    int added;
+    if (internSymbol(&ctx->symbols, nameId, &added) < 0 || !added)
+        return;   // the first declaration in the file wins, as in its table
+    const char *name = internedString(&ctx->strings, nameId);
+    unsigned len = ctx->strings.lengths[nameId];
+    const TokenBuffer *tokens = w->tokens;
+    size_t k = w->stepToken;
+    while (k + 1 < tokens->count &&
+           !(tokens->lengths[k] == len && memcmp(ctx->src->data + tokens->offsets[k], name, len) == 0))
+        k++;
+    Definition def = { name, declType, w->file, tokens->positions[k].row, tokens->positions[k].col,
+                       hashBytes(name, len) };
+    if (appendDefinition(w, &def) != 0)
+        w->stepFailed = 1;
+}
+
+// Lex one file and record its definitions.  Returns 0, or -1 if it cannot
+// be read or has no front end.
+static int indexFile(IndexWorker *w, int file) {
+    const char *path = w->index->files.paths[file];
+    const LanguageDescriptor *lang = indexLanguageFor(path);
+    SourceBuffer src;
+    if (!lang || srcOpen(&src, path) != 0)
+        return -1;
+
+    // The tokens live in the context's scratch arena until the file is done.
+    TokenBuffer tokens;
+    ArenaMark mark = arenaMark(&w->ctx.scratch);
+    int status = initTokenBufferIn(&tokens, &w->ctx.scratch, 4096, 1);
+    beginLexing(&w->ctx, &src);
+    if (status == 0)
+        status = lexTokens(&w->ctx, lang, &tokens, SIZE_MAX);
+
+    // Collect one step at a time, like relex.h, to know which token each
+    // declaration came from.
+    w->tokens = &tokens;
+    w->file = file;
+    w->stepFailed = 0;
+    w->ctx.declarationHook = recordDefinition;
+    w->ctx.hookData = w;
+    for (size_t t = 0; status >= 0 && t < tokens.count; ) {
+        w->stepToken = t;
+        t = lang->collectSymbols(&w->ctx, lang, &tokens, t, t + 1);
+    }
+    w->ctx.declarationHook = NULL;
+    w->ctx.hookData = NULL;
+    w->tokens = NULL;
+
+    resetSymbolTable(&w->ctx.symbols);
+    arenaRelease(&w->ctx.scratch, mark);
+    srcClose(&src);
+    return status >= 0 && !w->stepFailed ? 0 : -1;
+}
+
+static void *lexWorkerMain(void *arg) {
+    IndexWorker *w = arg;
+    ProjectIndex *ix = w->index;
+    int file;
+    while ((file = atomic_fetch_add(&ix->nextFile, 1)) < ix->files.count) {
+        if (indexFile(w, file) != 0) {
+            fprintf(stderr, "Cannot index %s\n", ix->files.paths[file]);
+            w->failed++;
+        }
+    }
+    LEXSTATS(mergeLexStats();)
+    return NULL;
+}
+
+/* ----------------------------------------------------------- pass 2: merge */
+
+static inline unsigned definitionShard(unsigned hash) {
+    return hash & (PROJECT_INDEX_SHARDS - 1);
+}
+
+static int definitionCompare(const void *a, const void *b) {
+    const Definition *x = a, *y = b;
+    unsigned sx = definitionShard(x->hash), sy = definitionShard(y->hash);
+    if (sx != sy)
+        return sx < sy ? -1 : 1;
+    if (x->hash != y->hash)
+        return x->hash < y->hash ? -1 : 1;
+    int c = strcmp(x->name, y->name);
+    if (c != 0)
+        return c;
+    if (x->file != y->file)
+        return x->file < y->file ? -1 : 1;
+    if (x->row != y->row)
+        return x->row < y->row ? -1 : 1;
+    return x->col < y->col ? -1 : x->col > y->col;
+}
+
+static inline int sameName(const Definition *a, const Definition *b) {
+    return a->hash == b->hash && strcmp(a->name, b->name) == 0;
+}
+
+// Build shard's name table over its sorted definitions.
+static int buildShard(IndexShard *shard) {
+    unsigned names = 0;
+    for (size_t i = 0; i < shard->count; i++)
+        names += i == 0 || !sameName(&shard->defs[i - 1], &shard->defs[i]);
+    unsigned size = 16;
+    while (size < names * 2)   // load at most 1/2
+        size *= 2;
+    if (!(shard->names = calloc(size, sizeof(IndexName))))
+        return -1;
+    shard->mask = size - 1;
+    shard->numNames = names;
+
+    for (size_t i = 0; i < shard->count; ) {
+        const Definition *d = &shard->defs[i];
+        size_t j = i + 1;
+        while (j < shard->count && sameName(&shard->defs[j], d))
+            j++;
+        // The low hash bits picked the shard; the rest pick the slot.
+        unsigned slot = (d->hash / PROJECT_INDEX_SHARDS) & shard->mask;
+        while (shard->names[slot].name)
+            slot = (slot + 1) & shard->mask;
+        shard->names[slot] = (IndexName){ d->name, d->hash, (unsigned)i, (unsigned)(j - i) };
+        i = j;
+    }
+    return 0;
+}
+
+static void *mergeWorkerMain(void *arg) {
+    IndexWorker *w = arg;
+    ProjectIndex *ix = w->index;
+    size_t total = 0;
+    for (int v = 0; v < ix->numWorkers; v++)
+        total += ix->workers[v].count;
+    if (!(w->merged = malloc((total ? total : 1) * sizeof(Definition)))) {
+        w->failed++;
+        return NULL;
+    }
+    for (int v = 0; v < ix->numWorkers; v++) {
+        const IndexWorker *from = &ix->workers[v];
+        for (size_t i = 0; i < from->count; i++) {
+            if ((int)(definitionShard(from->defs[i].hash) % ix->numWorkers) == w->id)
+                w->merged[w->mergedCount++] = from->defs[i];
+        }
+    }
+    qsort(w->merged, w->mergedCount, sizeof(Definition), definitionCompare);
+
+    for (size_t i = 0; i < w->mergedCount; ) {
+        unsigned s = definitionShard(w->merged[i].hash);
+        size_t j = i;
+        while (j < w->mergedCount && definitionShard(w->merged[j].hash) == s)
+            j++;
+        IndexShard *shard = &ix->shards[s];
+        shard->defs = w->merged + i;
+        shard->count = j - i;
+        if (buildShard(shard) != 0)
+            w->failed++;
+        i = j;
+    }
+    return NULL;
+}
+
+/* ---------------------------------------------------------------- building */
+
+// Run fn on every worker, worker 0 on this thread.
+static void runIndexWorkers(ProjectIndex *ix, void *(*fn)(void *)) {
+    for (int i = 1; i < ix->numWorkers; i++) {
+        if (pthread_create(&ix->workers[i].thread, NULL, fn, &ix->workers[i]) != 0)
+            ix->workers[i].thread = pthread_self();
+    }
+    fn(&ix->workers[0]);
+    for (int i = 1; i < ix->numWorkers; i++) {
+        if (pthread_equal(ix->workers[i].thread, pthread_self()))
+            fn(&ix->workers[i]);   // could not start a thread: do its share here
+        else
+            pthread_join(ix->workers[i].thread, NULL);
+    }
+}
+
+static void freeProjectIndex(ProjectIndex *ix) {
+    for (int s = 0; s < PROJECT_INDEX_SHARDS; s++)
+        free(ix->shards[s].names);
+    for (int i = 0; i < ix->numWorkers; i++) {
+        IndexWorker *w = &ix->workers[i];
+        free(w->defs);
+        free(w->merged);
+        freeLexerContext(&w->ctx);
+    }
+    free(ix->workers);
+    freeFileList(&ix->files);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/*
+ * Index files (the index takes the list over) on jobs threads.  Returns 0
+ * if every file was indexed, 1 if some could not be read (the index has
+ * the rest), -1 if out of memory.
+ */
+static int buildProjectIndex(ProjectIndex *ix, FileList *files, int jobs) {
+    memset(ix, 0, sizeof(*ix));
+    ix->files = *files;
+    memset(files, 0, sizeof(*files));
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > PROJECT_INDEX_SHARDS)
+        jobs = PROJECT_INDEX_SHARDS;
+    if (!(ix->workers = calloc(jobs, sizeof(IndexWorker))))
+        return -1;
+    ix->numWorkers = jobs;
+    for (int i = 0; i < jobs; i++) {
+        ix->workers[i].index = ix;
+        ix->workers[i].id = i;
+        initLexerContext(&ix->workers[i].ctx);
+    }
+
+    double start = indexSeconds();
+    atomic_init(&ix->nextFile, 0);
+    runIndexWorkers(ix, lexWorkerMain);
+    double lexed = indexSeconds();
+
+    int failed = 0, outOfMemory = 0;
+    for (int i = 0; i < jobs; i++) {
+        failed += ix->workers[i].failed;
+        ix->workers[i].failed = 0;
+        ix->definitions += ix->workers[i].count;
+    }
+    runIndexWorkers(ix, mergeWorkerMain);
+    for (int i = 0; i < jobs; i++)
+        outOfMemory += ix->workers[i].failed;
+    for (int s = 0; s < PROJECT_INDEX_SHARDS; s++)
+        ix->names += ix->shards[s].numNames;
+
+    ix->lexSeconds = lexed - start;
+    ix->mergeSeconds = indexSeconds() - lexed;
+    ix->failed = failed;
+    ix->scanned = ix->files.count - failed;
+    return outOfMemory ? -1 : failed ? 1 : 0;
+}
+
+/* ----------------------------------------------------------------- queries */
+
+// The definitions of name, in file-list order and then by position, and
+// their number in *count; NULL if there are none.  Lock-free: safe from
+// any number of threads once buildProjectIndex has returned.
+static const Definition *findDefinitions(const ProjectIndex *ix, const char *name, size_t *count) {
+    unsigned hash = hashBytes(name, strlen(name));
+    const IndexShard *shard = &ix->shards[definitionShard(hash)];
+    *count = 0;
+    if (!shard->names)
+        return NULL;
+    for (unsigned slot = (hash / PROJECT_INDEX_SHARDS) & shard->mask; shard->names[slot].name;
+         slot = (slot + 1) & shard->mask) {
+        const IndexName *n = &shard->names[slot];
+        if (n->hash == hash && strcmp(n->name, name) == 0) {
+            *count = n->count;
+            return shard->defs + n->first;
+        }
+    }
+    return NULL;
+}
+
+static inline const char *definitionFile(const ProjectIndex *ix, const Definition *def) {
+    return ix->files.paths[def->file];
+}
+
+#endif
@@ -0,0 +1,565 @@
+#ifndef RELEX_H
+#define RELEX_H
+
+/*
+ * Incremental re-lexing for editor integration.
+ *
+ * A LexDocument owns a copy of the text, its token stream (with rows and
+ * columns), the declarations the language's collector found and a lexer
+ * context (lexctx.h) whose symbol table it keeps in step with them.  editLexDocument replaces a
+ * byte range and redoes only the work the edit can have changed:
+ *
+ *  - Tokens.  Token j is the result of a getNextToken call that started
+ *    where token j-1 ended, and it read no further than one byte past its
+ *    own end.  Re-lexing starts at the first token whose bytes reach the
+ *    edit, from that token's saved row and column.  As in parlex.h, a token
+ *    depends only on its start position while row and col are carried
+ *    along, so once a new token starts where an old one did (shifted by
+ *    the edit) at the same column, every later old token is still right
+ *    apart from a constant row offset, and re-lexing stops there.
+ *
+ *  - Declarations.  The collector is run one loop step at a time, and each
+ *    step is remembered with the token it resumes at.  A step only reads
+ *    tokens up to that one (its lookahead), so the steps that need redoing
+ *    are the one covering the token before the first re-lexed one, through
+ *    to the first old step boundary past the re-lexed tokens.
+ *
+ *  - Symbols.  The table holds each name's first declaration, in the order
+ *    of those declarations.  Only names declared in the redone steps can
+ *    change; their entries are dropped and re-added at their new first
+ *    declaration, and everything else keeps its entry.
+ *
+ * The result (tokens, rows, columns and symbol table) is the same as
+ * lexing the edited text from scratch.  Documents share nothing, so any
+ * number can be open at once, on any threads.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "lexer.h"
+#include "tokbuf.h"
+
+typedef struct {
+    size_t token;         // collector step (its first token) that found it
+    unsigned nameId;
+    const char *type;
+} Declaration;
+
+typedef struct {
+    Declaration *items;
+    size_t count, capacity;
+} DeclarationList;
+
+typedef struct {
+    const LanguageDescriptor *lang;
+    LexerContext ctx;          // ctx.symbols is the document's symbol table
+    char *text;
+    size_t len, capacity;
+    TokenBuffer tokens;        // with positions
+    size_t *stepEnds;          // for a token that starts a collector step, where the next step starts; else 0
+    size_t stepCapacity;
+    int tailRow, tailCol;      // lexer state after the last token
+    DeclarationList decls;     // in token order
+    size_t *firstDecls;        // step of each symbol table entry's first declaration
+    size_t firstCapacity;
+    unsigned char *marks;      // by name id, scratch for patchSymbols (all 0 between edits)
+    size_t markCapacity;
+    DeclarationList *stepDecls;   // where recordDeclaration appends, during collectSteps
+    size_t stepToken;
+    int stepFailed;
+
+    // What the last edit redid, for benchmarks.
+    size_t relexedTokens, recollectedTokens;
+} LexDocument;
+
+static int appendDeclaration(DeclarationList *list, size_t token, unsigned nameId, const char *type) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        Declaration *items = realloc(list->items, capacity * sizeof(Declaration));
+        if (!items)
+            return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].token = token;
+    list->items[list->count].nameId = nameId;
+    list->items[list->count].type = type;
+    list->count++;
+    return 0;
+}
+
+// LexerContext.declarationHook while collecting; hookData is the document.
+static void recordDeclaration(LexerContext *ctx, unsigned nameId, const char *declType) {
+    LexDocument *doc = ctx->hookData;
+    if (appendDeclaration(doc->stepDecls, doc->stepToken, nameId, declType) != 0)
+        doc->stepFailed = 1;
+}
+
+static SourceBuffer documentSource(const LexDocument *doc) {
+    SourceBuffer src = { doc->text, doc->len, 0, 0 };
+    return src;
+}
+
+static int reserveSteps(LexDocument *doc, size_t count) {
+    if (count < doc->stepCapacity)
+        return 0;
+    size_t capacity = doc->stepCapacity ? doc->stepCapacity : 4096;
+    while (capacity <= count)
+        capacity *= 2;
+    size_t *steps = realloc(doc->stepEnds, capacity * sizeof(size_t));
+    if (!steps)
+        return -1;
+    doc->stepEnds = steps;
+    doc->stepCapacity = capacity;
+    return 0;
+}
+
+/*
+ * Run collector steps from token t, appending what they declare to out,
+ * until the end of the tokens or, at or after token resync, the start of
+ * a step left from before.  Returns where it stopped, or SIZE_MAX if out
+ * of memory.
+ */
+static size_t collectSteps(LexDocument *doc, size_t t, size_t resync, DeclarationList *out) {
+    SourceBuffer src = documentSource(doc);
+    size_t count = doc->tokens.count;
+    doc->stepDecls = out;
+    doc->stepFailed = 0;
+    doc->ctx.src = &src;
+    doc->ctx.declarationHook = recordDeclaration;
+    doc->ctx.hookData = doc;
+    while (t < count && !(t >= resync && doc->stepEnds[t] != 0)) {
+        doc->stepToken = t;
+        size_t next = doc->lang->collectSymbols(&doc->ctx, doc->lang, &doc->tokens, t, t + 1);
+        size_t inner = (next < count ? next : count) - (t + 1);
+        memset(doc->stepEnds + t + 1, 0, inner * sizeof(size_t));
+        doc->stepEnds[t] = next;
+        t = next;
+    }
+    doc->ctx.declarationHook = NULL;
+    doc->ctx.hookData = NULL;
+    return doc->stepFailed ? SIZE_MAX : t;
+}
+
+static int reserveFirstDecls(LexDocument *doc, size_t count) {
+    if (count <= doc->firstCapacity)
+        return 0;
+    size_t capacity = doc->firstCapacity ? doc->firstCapacity : 256;
+    while (capacity < count)
+        capacity *= 2;
+    size_t *first = realloc(doc->firstDecls, capacity * sizeof(size_t));
+    if (!first)
+        return -1;
+    doc->firstDecls = first;
+    doc->firstCapacity = capacity;
+    return 0;
+}
+
+static int reserveSymbols(SymbolTable *table, int count) {
+    if (count <= table->capacity)
+        return 0;
+    int capacity = table->capacity ? table->capacity : 64;
+    while (capacity < count)
+        capacity *= 2;
+    SymbolTableEntry *entries = realloc(table->entries, capacity * sizeof(SymbolTableEntry));
+    if (!entries)
+        return -1;
+    table->entries = entries;
+    table->capacity = capacity;
+    return 0;
+}
+
+// Lex all of the text and collect its declarations into a fresh table.
+static int rebuildLexDocument(LexDocument *doc) {
+    LexerContext *ctx = &doc->ctx;
+    SourceBuffer src = documentSource(doc);
+    freeTokenBuffer(&doc->tokens);
+    beginLexing(ctx, &src);
+    for (;;) {
+        int entryRow = ctx->row, entryCol = ctx->col;
+        Token token = getNextToken(ctx, doc->lang);
+        if (token.kind == TOKEN_EOF) {
+            doc->tailRow = entryRow;
+            doc->tailCol = entryCol;
+            break;
+        }
+        if (pushToken(&doc->tokens, &token) != 0)
+            return -1;
+    }
+    if (reserveSteps(doc, doc->tokens.count) != 0)
+        return -1;
+    memset(doc->stepEnds, 0, (doc->tokens.count + 1) * sizeof(size_t));
+    doc->decls.count = 0;
+    if (collectSteps(doc, 0, SIZE_MAX, &doc->decls) == SIZE_MAX)
+        return -1;
+
+    freeSymbolTable(&ctx->symbols);
+    for (size_t i = 0; i < doc->decls.count; i++) {
+        const Declaration *d = &doc->decls.items[i];
+        int added;
+        int idx = internSymbol(&ctx->symbols, d->nameId, &added);
+        if (idx < 0 || reserveFirstDecls(doc, (size_t)ctx->symbols.count) != 0)
+            return -1;
+        if (added) {
+            fillSymbolEntry(&ctx->symbols.entries[idx], d->nameId, internedString(&ctx->strings, d->nameId),
+                            d->type);
+            doc->firstDecls[idx] = d->token;
+        }
+    }
+    doc->relexedTokens = doc->tokens.count;
+    doc->recollectedTokens = doc->tokens.count;
+    return 0;
+}
+
+// Open a document on a copy of text[0..len).  Returns 0, or -1 if out of
+// memory.
+int openLexDocument(LexDocument *doc, const LanguageDescriptor *lang, const char *text, size_t len) {
+    memset(doc, 0, sizeof(*doc));
+    doc->lang = lang;
+    initLexerContext(&doc->ctx);
+    initTokenBuffer(&doc->tokens, 1);
+    doc->capacity = len + 1;
+    doc->text = malloc(doc->capacity);
+    if (!doc->text)
+        return -1;
+    memcpy(doc->text, text, len);
+    doc->len = len;
+    return rebuildLexDocument(doc);
+}
+
+void closeLexDocument(LexDocument *doc) {
+    free(doc->text);
+    freeTokenBuffer(&doc->tokens);
+    free(doc->stepEnds);
+    free(doc->decls.items);
+    free(doc->firstDecls);
+    free(doc->marks);
+    freeLexerContext(&doc->ctx);
+    memset(doc, 0, sizeof(*doc));
+}
+
+// Where the getNextToken call for token j started (j may be the count,
+// meaning the call that returned EOF).
+static inline size_t tokenEntry(const TokenBuffer *tokens, size_t j) {
+    return j ? tokens->offsets[j - 1] + tokens->lengths[j - 1] : 0;
+}
+
+/*
+ * Re-lex the tokens changed by replacing bytes [start, end) of the old
+ * text with n bytes (the text has already been edited).  The changed old
+ * tokens are [first, *oldResync) and are replaced by the ones in fresh;
+ * old tokens from *oldResync on move by *rowDelta rows.
+ */
+static int relexChanged(LexDocument *doc, size_t first, size_t start, size_t end, size_t n,
+                        TokenBuffer *fresh, size_t *oldResync, int *rowDelta) {
+    const TokenBuffer *old = &doc->tokens;
+    LexerContext *ctx = &doc->ctx;
+    SourceBuffer src = documentSource(doc);
+    size_t editEnd = start + n;       // in the new text
+    size_t k = first;                 // old token candidate to resync on
+    ctx->src = &src;
+    src.pos = tokenEntry(old, first);
+    if (first < old->count) {
+        ctx->row = old->positions[first].row;
+        ctx->col = old->positions[first].col;
+    } else {
+        ctx->row = doc->tailRow;
+        ctx->col = doc->tailCol;
+    }
+
+    for (;;) {
+        if (src.pos >= editEnd) {
+            size_t oldPos = src.pos - editEnd + end;
+            while (k < old->count && tokenEntry(old, k) < oldPos)
+                k++;
+            if (tokenEntry(old, k) == oldPos) {
+                int oldRow = k < old->count ? old->positions[k].row : doc->tailRow;
+                int oldCol = k < old->count ? old->positions[k].col : doc->tailCol;
+                if (oldCol == ctx->col) {
+                    *oldResync = k;
+                    *rowDelta = ctx->row - oldRow;
+                    doc->tailRow += *rowDelta;
+                    return 0;
+                }
+            }
+        }
+        int entryRow = ctx->row, entryCol = ctx->col;
+        Token token = getNextToken(ctx, doc->lang);
+        if (token.kind == TOKEN_EOF) {
+            doc->tailRow = entryRow;
+            doc->tailCol = entryCol;
+            *oldResync = old->count;
+            *rowDelta = 0;
+            return 0;
+        }
+        if (pushToken(fresh, &token) != 0)
+            return -1;
+    }
+}
+
+// Replace old tokens [first, oldResync) with fresh, moving the rest.
+static int spliceTokens(LexDocument *doc, size_t first, size_t oldResync, const TokenBuffer *fresh,
+                        ptrdiff_t byteDelta, int rowDelta) {
+    TokenBuffer *tokens = &doc->tokens;
+    size_t tail = tokens->count - oldResync;
+    size_t count = first + fresh->count + tail;
+    while (tokens->capacity < count) {
+        if (growTokenBuffer(tokens) != 0)
+            return -1;
+    }
+    if (reserveSteps(doc, count) != 0)
+        return -1;
+
+    size_t to = first + fresh->count;
+    if (to != oldResync) {
+        memmove(tokens->kinds + to, tokens->kinds + oldResync, tail);
+        memmove(tokens->offsets + to, tokens->offsets + oldResync, tail * sizeof(size_t));
+        memmove(tokens->lengths + to, tokens->lengths + oldResync, tail * sizeof(unsigned));
+        memmove(tokens->positions + to, tokens->positions + oldResync, tail * sizeof(TokenPos));
+        memmove(doc->stepEnds + to, doc->stepEnds + oldResync, tail * sizeof(size_t));
+    }
+    if (fresh->count) {
+        memcpy(tokens->kinds + first, fresh->kinds, fresh->count);
+        memcpy(tokens->offsets + first, fresh->offsets, fresh->count * sizeof(size_t));
+        memcpy(tokens->lengths + first, fresh->lengths, fresh->count * sizeof(unsigned));
+        memcpy(tokens->positions + first, fresh->positions, fresh->count * sizeof(TokenPos));
+        memset(doc->stepEnds + first, 0, fresh->count * sizeof(size_t));
+    }
+    ptrdiff_t shift = (ptrdiff_t)to - (ptrdiff_t)oldResync;
+    for (size_t i = to; byteDelta && i < count; i++)
+        tokens->offsets[i] += byteDelta;
+    for (size_t i = to; rowDelta && i < count; i++)
+        tokens->positions[i].row += rowDelta;
+    for (size_t i = to; shift && i < count; i++) {
+        if (doc->stepEnds[i])
+            doc->stepEnds[i] += shift;
+    }
+    doc->stepEnds[count] = 0;
+    tokens->count = count;
+    return 0;
+}
+
+// First declaration at or after token t.
+static size_t findDeclaration(const DeclarationList *list, size_t t) {
+    size_t lo = 0, hi = list->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (list->items[mid].token < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * The declarations of steps [restart, stop) (new numbering) are now
+ * fresh instead of the old ones in decls[from, to).  Splice them in and
+ * re-place the symbols of every name involved.
+ */
+static int patchSymbols(LexDocument *doc, size_t restart, size_t oldResync, ptrdiff_t shift, size_t from,
+                        size_t to, const DeclarationList *fresh) {
+    DeclarationList *decls = &doc->decls;
+    SymbolTable *table = &doc->ctx.symbols;
+    unsigned names = doc->ctx.strings.count;
+    if (names > doc->markCapacity) {
+        unsigned char *marks = realloc(doc->marks, names);
+        if (!marks)
+            return -1;
+        memset(marks + doc->markCapacity, 0, names - doc->markCapacity);
+        doc->marks = marks;
+        doc->markCapacity = names;
+    }
+
+    // Names whose first declaration may have moved: anything declared in
+    // the redone steps, unless it was already declared before them.
+    size_t maxMarked = (to - from) + fresh->count;
+    unsigned *markedIds = malloc((maxMarked ? maxMarked : 1) * sizeof(unsigned));
+    if (!markedIds)
+        return -1;
+    size_t numMarked = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        const Declaration *items = pass ? fresh->items : decls->items + from;
+        size_t count = pass ? fresh->count : to - from;
+        for (size_t i = 0; i < count; i++) {
+            unsigned id = items[i].nameId;
+            int idx = id < table->idCapacity ? table->byId[id] : 0;
+            if ((!idx || doc->firstDecls[idx - 1] >= restart) && !doc->marks[id]) {
+                doc->marks[id] = 1;
+                markedIds[numMarked++] = id;
+            }
+        }
+    }
+
+    int status = -1;
+    DeclarationList added = { NULL, 0, 0 };
+
+    // Splice the declaration list.
+    size_t tail = decls->count - to;
+    size_t count = from + fresh->count + tail;
+    if (count > decls->capacity) {
+        Declaration *items = realloc(decls->items, count * sizeof(Declaration));
+        if (!items)
+            goto done;
+        decls->items = items;
+        decls->capacity = count;
+    }
+    memmove(decls->items + from + fresh->count, decls->items + to, tail * sizeof(Declaration));
+    memcpy(decls->items + from, fresh->items, fresh->count * sizeof(Declaration));
+    for (size_t i = from + fresh->count; i < count; i++)
+        decls->items[i].token += shift;
+    decls->count = count;
+
+    // Entries whose first declaration comes before the redone steps stay
+    // as they are.  Of the rest, drop the marked names and move the others
+    // along.
+    int lo = 0, hi = table->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (doc->firstDecls[mid] < restart)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    int unchanged = lo, kept = lo;
+    for (int i = unchanged; i < table->count; i++) {
+        if (doc->marks[table->entries[i].nameId])
+            continue;
+        size_t firstDecl = doc->firstDecls[i];
+        if (firstDecl >= oldResync)
+            firstDecl += shift;
+        table->entries[kept] = table->entries[i];
+        doc->firstDecls[kept] = firstDecl;
+        kept++;
+    }
+
+    // Find the marked names' new first declarations, in order.
+    for (size_t i = findDeclaration(decls, restart); i < decls->count && added.count < numMarked; i++) {
+        const Declaration *d = &decls->items[i];
+        if (doc->marks[d->nameId]) {
+            doc->marks[d->nameId] = 0;
+            if (appendDeclaration(&added, d->token, d->nameId, d->type) != 0)
+                goto done;
+        }
+    }
+
+    // Merge them into the kept entries by first declaration, from the back.
+    int total = kept + (int)added.count;
+    if (reserveSymbols(table, total) != 0 || reserveFirstDecls(doc, (size_t)total) != 0)
+        goto done;
+    int i = kept - 1, j = (int)added.count - 1;
+    for (int out = total - 1; out >= unchanged; out--) {
+        if (j < 0 || (i >= unchanged && doc->firstDecls[i] > added.items[j].token)) {
+            table->entries[out] = table->entries[i];
+            doc->firstDecls[out] = doc->firstDecls[i];
+            i--;
+        } else {
+            unsigned id = added.items[j].nameId;
+            fillSymbolEntry(&table->entries[out], id, internedString(&doc->ctx.strings, id), added.items[j].type);
+            doc->firstDecls[out] = added.items[j].token;
+            j--;
+        }
+    }
+    table->count = total;
+
+    // Renumber the index past the unchanged entries.
+    for (size_t m = 0; m < numMarked; m++) {
+        if (markedIds[m] < table->idCapacity)
+            table->byId[markedIds[m]] = 0;
+    }
+    for (int e = unchanged; e < total; e++) {
+        unsigned id = table->entries[e].nameId;
+        if (id >= table->idCapacity && growSymbolIndex(table, id) != 0)
+            goto done;
+        table->byId[id] = e + 1;
+    }
+    status = 0;
+
+done:
+    for (size_t m = 0; m < numMarked; m++)
+        doc->marks[markedIds[m]] = 0;
+    free(markedIds);
+    free(added.items);
+    return status;
+}
+
+/*
+ * Replace bytes [start, end) of the document with text[0..n) and bring the
+ * tokens and symbol table up to date.  Returns 0, or -1 for a bad range or
+ * if out of memory.  Running out of memory part way falls back to
+ * rebuilding the document from scratch, and the result is the rebuild's.
+ */
+int editLexDocument(LexDocument *doc, size_t start, size_t end, const char *text, size_t n) {
+    if (start > end || end > doc->len)
+        return -1;
+
+    // Edit the text.
+    size_t len = doc->len - (end - start) + n;
+    if (len + 1 > doc->capacity) {
+        size_t capacity = doc->capacity * 2 > len + 1 ? doc->capacity * 2 : len + 1;
+        char *grown = realloc(doc->text, capacity);
+        if (!grown)
+            return -1;
+        doc->text = grown;
+        doc->capacity = capacity;
+    }
+    memmove(doc->text + start + n, doc->text + end, doc->len - end);
+    memcpy(doc->text + start, text, n);
+    doc->len = len;
+    ptrdiff_t byteDelta = (ptrdiff_t)n - (ptrdiff_t)(end - start);
+
+    // First token that read a byte at or after start (one past its end for
+    // the lookahead that ends identifiers, numbers and operators).
+    TokenBuffer *tokens = &doc->tokens;
+    size_t lo = 0, hi = tokens->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tokens->offsets[mid] + tokens->lengths[mid] + 1 <= start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    size_t first = lo;
+
+    // The re-lexed tokens only live until they are spliced in.
+    TokenBuffer fresh;
+    ArenaMark mark = arenaMark(&doc->ctx.scratch);
+    size_t oldResync;
+    int rowDelta;
+    if (initTokenBufferIn(&fresh, &doc->ctx.scratch, 256, 1) != 0 ||
+        relexChanged(doc, first, start, end, n, &fresh, &oldResync, &rowDelta) != 0 ||
+        spliceTokens(doc, first, oldResync, &fresh, byteDelta, rowDelta) != 0) {
+        arenaRelease(&doc->ctx.scratch, mark);
+        return rebuildLexDocument(doc);
+    }
+    size_t newResync = first + fresh.count;
+    ptrdiff_t shift = (ptrdiff_t)newResync - (ptrdiff_t)oldResync;
+    doc->relexedTokens = fresh.count;
+    arenaRelease(&doc->ctx.scratch, mark);
+
+    // Redo collector steps from the one covering the token before the
+    // first re-lexed one (it may have looked ahead into it).
+    size_t restart = first ? first - 1 : 0;
+    while (restart > 0 && doc->stepEnds[restart] == 0)
+        restart--;
+    size_t from = findDeclaration(&doc->decls, restart);
+    DeclarationList redone = { NULL, 0, 0 };
+    size_t stop = collectSteps(doc, restart, newResync, &redone);
+    if (stop == SIZE_MAX) {
+        free(redone.items);
+        return rebuildLexDocument(doc);
+    }
+    doc->recollectedTokens = stop - restart;
+
+    // Old declarations up to the step we stopped at were redone.
+    size_t oldStop = stop >= newResync ? (size_t)((ptrdiff_t)stop - shift) : oldResync;
+    size_t to = findDeclaration(&doc->decls, oldStop);
+    if (stop >= doc->tokens.count)
+        to = doc->decls.count;
+    int status = patchSymbols(doc, restart, oldResync, shift, from, to, &redone);
+    free(redone.items);
+    return status == 0 ? 0 : rebuildLexDocument(doc);
+}
+
+#endif
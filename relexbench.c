@@ -0,0 +1,241 @@
+// Incremental re-lexing benchmark: applies random small edits to a file
+// through a LexDocument (relex.h) and compares the time per edit with
+// lexing and collecting the whole edited text again.
+//
+//     gcc -O2 -pthread relexbench.c -o relexbench
+//     ./relexbench file [language] [--edits N] [--typing] [--verify]
+//
+// language is javascript, c, java, csharp, ruby or perl; by default it is
+// picked from the file's extension.  Edits insert, delete or replace a few
+// bytes at random places (--typing: insert one byte at a time at a single
+// spot, like a user typing).  --verify checks the document after every
+// edit against a from-scratch run on another thread: tokens, rows,
+// columns and the symbol table must all match.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "languages.h"
+#include "relex.h"
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const LanguageDescriptor *pickLanguage(const char *path, const char *name) {
+    static const struct { const char *name, *ext; const LanguageDescriptor *lang; } table[] = {
+        { "javascript", ".js", &javascriptLanguage }, { "c", ".c", &cLanguage },
+        { "java", ".java", &javaLanguage }, { "csharp", ".cs", &csharpLanguage },
+        { "ruby", ".rb", &rubyLanguage }, { "perl", ".pl", &perlLanguage },
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (name ? strcmp(name, table[i].name) == 0 : hasExtension(path, table[i].ext))
+            return table[i].lang;
+    }
+    return name ? NULL : &javascriptLanguage;
+}
+
+static unsigned randomState = 2463534242u;
+
+static unsigned nextRandom(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// Snippets chosen to open and close strings and comments and to add and
+// remove declarations, not just to change identifiers.
+static const char *const snippets[] = {
+    "x", "1", " ", "\n", "\"", "'", "/", "//", "#", "*/", "(", ")", "{", "}", ";", "=", "==",
+    "int v = 2;\n", "var w;", "function g() {", "def h\n", "end\n", "sub k {", "my $m = 1;",
+    "public static void f(int a) {", "String s", "\"text\"", "/* note */",
+};
+
+#define NUM_SNIPPETS (sizeof(snippets) / sizeof(snippets[0]))
+
+typedef struct {
+    size_t start, end;
+    const char *text;
+} Edit;
+
+static Edit randomEdit(size_t len) {
+    Edit e;
+    e.start = len ? nextRandom() % (len + 1) : 0;
+    size_t span = nextRandom() % 3 == 0 ? 0 : nextRandom() % 16;
+    e.end = e.start + span < len ? e.start + span : len;
+    e.text = nextRandom() % 4 == 0 ? "" : snippets[nextRandom() % NUM_SNIPPETS];
+    return e;
+}
+
+/* ------------------------------------------------------------- verifying */
+
+typedef struct {
+    const LexDocument *doc;
+    const SymbolTable *table;   // the document's
+    int ok;
+    char message[256];
+} Verify;
+
+// A from-scratch run in a context of its own, on another thread while the
+// document's sits idle.
+static void *verifyMain(void *arg) {
+    Verify *v = arg;
+    const LexDocument *doc = v->doc;
+    SourceBuffer src = { doc->text, doc->len, 0, 0 };
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, &src);
+    v->ok = 0;
+
+    size_t i = 0;
+    for (;; i++) {
+        int entryRow = ctx.row, entryCol = ctx.col;
+        Token t = getNextToken(&ctx, doc->lang);
+        if (t.kind == TOKEN_EOF) {
+            if (i != doc->tokens.count) {
+                snprintf(v->message, sizeof(v->message), "%zu tokens, expected %zu", doc->tokens.count, i);
+                goto done;
+            }
+            if (entryRow != doc->tailRow || entryCol != doc->tailCol) {
+                snprintf(v->message, sizeof(v->message), "tail at %d:%d, expected %d:%d", doc->tailRow,
+                         doc->tailCol, entryRow, entryCol);
+                goto done;
+            }
+            break;
+        }
+        if (i >= doc->tokens.count || doc->tokens.kinds[i] != t.kind || doc->tokens.offsets[i] != t.offset ||
+            doc->tokens.lengths[i] != (unsigned)t.length || doc->tokens.positions[i].row != t.row ||
+            doc->tokens.positions[i].col != t.col) {
+            snprintf(v->message, sizeof(v->message), "token %zu differs (expected %d:%d \"%.*s\")", i, t.row,
+                     t.col, t.length, src.data + t.offset);
+            goto done;
+        }
+    }
+
+    generateSymbolTable(&ctx, doc->lang, &src);
+    if (ctx.symbols.count != v->table->count) {
+        snprintf(v->message, sizeof(v->message), "%d symbols, expected %d", v->table->count, ctx.symbols.count);
+    } else {
+        v->ok = 1;
+        for (int k = 0; k < ctx.symbols.count && v->ok; k++) {
+            const SymbolTableEntry *want = &ctx.symbols.entries[k], *got = &v->table->entries[k];
+            if (strcmp(want->name, got->name) != 0 || strcmp(want->type, got->type) != 0 ||
+                want->hash != got->hash) {
+                snprintf(v->message, sizeof(v->message), "symbol %d is %s %s, expected %s %s", k, got->type,
+                         got->name, want->type, want->name);
+                v->ok = 0;
+            }
+        }
+    }
+done:
+    freeLexerContext(&ctx);
+    return NULL;
+}
+
+static int verifyDocument(const LexDocument *doc, char *message, size_t size) {
+    Verify v = { doc, &doc->ctx.symbols, 0, "" };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, verifyMain, &v) != 0) {
+        snprintf(message, size, "cannot start thread");
+        return -1;
+    }
+    pthread_join(thread, NULL);
+    snprintf(message, size, "%s", v.message);
+    return v.ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL, *name = NULL;
+    int edits = 1000, typing = 0, verify = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--edits") == 0 && i + 1 < argc)
+            edits = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--typing") == 0)
+            typing = 1;
+        else if (strcmp(argv[i], "--verify") == 0)
+            verify = 1;
+        else if (!path)
+            path = argv[i];
+        else
+            name = argv[i];
+    }
+    if (!path || edits < 1) {
+        printf("usage: %s file [language] [--edits N] [--typing] [--verify]\n", argv[0]);
+        return 1;
+    }
+    const LanguageDescriptor *lang = pickLanguage(path, name);
+    if (!lang) {
+        printf("Unknown language %s\n", name);
+        return 1;
+    }
+    SourceBuffer src;
+    if (srcOpen(&src, path) != 0) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    selectScanKernels();
+
+    LexDocument doc;
+    double start = nowSeconds();
+    if (openLexDocument(&doc, lang, src.data, src.len) != 0) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    double openSeconds = nowSeconds() - start;
+    srcClose(&src);
+    printf("%s (%s): %zu bytes, %zu tokens, %d symbols, open %.2f ms\n", path, lang->name, doc.len,
+           doc.tokens.count, doc.ctx.symbols.count, openSeconds * 1e3);
+
+    double editSeconds = 0;
+    size_t relexed = 0, recollected = 0;
+    size_t typingAt = doc.len / 2;
+    char key[2] = "";
+    for (int i = 0; i < edits; i++) {
+        Edit e;
+        if (typing) {
+            static const char keys[] = "int total = count + 1; // sum\n";
+            key[0] = keys[i % (sizeof(keys) - 1)];
+            e.start = e.end = typingAt++;
+            e.text = key;
+        } else {
+            e = randomEdit(doc.len);
+        }
+        start = nowSeconds();
+        int status = editLexDocument(&doc, e.start, e.end, e.text, strlen(e.text));
+        editSeconds += nowSeconds() - start;
+        if (status != 0) {
+            printf("edit %d failed\n", i);
+            return 1;
+        }
+        relexed += doc.relexedTokens;
+        recollected += doc.recollectedTokens;
+
+        char message[256];
+        if (verify && verifyDocument(&doc, message, sizeof(message)) != 0) {
+            printf("edit %d (replace %zu..%zu with \"%s\"): %s\n", i, e.start, e.end, e.text, message);
+            return 1;
+        }
+    }
+
+    // The cost of the alternative: everything from scratch on the final text.
+    start = nowSeconds();
+    for (int i = 0; i < 3; i++) {
+        if (rebuildLexDocument(&doc) != 0) {
+            printf("Out of memory\n");
+            return 1;
+        }
+    }
+    double fullSeconds = (nowSeconds() - start) / 3;
+
+    printf("%d edits: %.1f us per edit, %.1f tokens re-lexed and %.1f re-collected on average\n", edits,
+           editSeconds * 1e6 / edits, (double)relexed / edits, (double)recollected / edits);
+    printf("full re-lex: %.1f us (%.0fx)%s\n", fullSeconds * 1e6, fullSeconds * edits / editSeconds,
+           verify ? ", every edit verified" : "");
+    closeLexDocument(&doc);
+    return 0;
+}
@@ -0,0 +1,319 @@
+#ifndef SCOPE_H
+#define SCOPE_H
+
+/*
+ * Block-scoped symbol tables (--scopes).
+ *
+ * The flat table in symtab.h keeps one entry per name, so a parameter and
+ * a local of the same name in different methods collapse into one.  Here a
+ * name is only a duplicate if it is declared again in the same scope, and
+ * every entry records the scope it was declared in.
+ *
+ * Scopes are opened and closed by tokens the language picks
+ * (LanguageDescriptor.scopeDelta): braces by default, def/class/.../end
+ * blocks in Ruby.  The visible bindings live in one chained hash table
+ * keyed by intern id.  A new binding goes to the front of its chain, so
+ * the first match is always the innermost one.  Each binding is also
+ * linked into its scope's list.  Closing the scope pops its bindings off
+ * their chains, where they are still at the front, and puts them back in
+ * the table's binding pool, where the next scope's declarations find them.  Closing costs one step per name the scope declared no
+ * matter how deep the nesting, and lookups are a short chain walk.  The
+ * entries printed at the end are kept separately and outlive their
+ * scopes.
+ *
+ * The pool (ObjectPool) hands out fixed-size objects that come and go in
+ * any order, carved from an arena (arena.h) and recycled through a free
+ * list, so a scope closed in a loop hands its bindings straight to the
+ * next one.  With LEXER_STATS it counts gets and how many were recycled.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "tokbuf.h"
+
+typedef struct PoolItem {
+    struct PoolItem *next;
+} PoolItem;
+
+typedef struct {
+    Arena arena;
+    PoolItem *free;         // objects given back, newest first
+    size_t itemSize;
+} ObjectPool;
+
+static void initObjectPool(ObjectPool *pool, size_t itemSize) {
+    memset(pool, 0, sizeof(*pool));
+    if (itemSize < sizeof(PoolItem))
+        itemSize = sizeof(PoolItem);
+    pool->itemSize = (itemSize + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// An object of the pool's size, recycled if one has been put back.
+static void *poolGet(ObjectPool *pool) {
+    PoolItem *item = pool->free;
+    LEXSTATS(lexStats.poolGets++;)
+    if (!item)
+        return arenaAllocAligned(&pool->arena, pool->itemSize);
+    pool->free = item->next;
+    LEXSTATS(lexStats.poolRecycled++;)
+    return item;
+}
+
+static void poolPut(ObjectPool *pool, void *object) {
+    PoolItem *item = object;
+    item->next = pool->free;
+    pool->free = item;
+}
+
+static void freeObjectPool(ObjectPool *pool) {
+    size_t itemSize = pool->itemSize;
+    freeArena(&pool->arena);
+    memset(pool, 0, sizeof(*pool));
+    pool->itemSize = itemSize;
+}
+
+typedef struct {
+    SymbolTableEntry symbol;
+    int scope;     // 0 for the file, then numbered in the order blocks open
+    int depth;     // nesting depth of that scope
+} ScopedSymbolEntry;
+
+typedef struct ScopedBinding {
+    struct ScopedBinding *next;       // same bucket, innermost first
+    struct ScopedBinding *sameScope;  // binding declared before this one in its scope
+    unsigned nameId;
+    int depth;
+    int entry;                        // index into ScopedSymbolTable.entries
+} ScopedBinding;
+
+typedef struct {
+    ScopedBinding *bindings;          // newest first
+    int scope;
+} ScopeFrame;
+
+typedef struct {
+    ScopedSymbolEntry *entries;       // every declaration kept, in order
+    int count, capacity;
+    ScopedBinding **buckets;          // by nameId & bucketMask
+    unsigned bucketMask, live;        // live = bindings currently visible
+    ScopeFrame *frames;               // frames[0] is the file scope
+    int depth, frameCapacity;
+    int scopes;                       // blocks opened so far
+    ObjectPool bindings;              // ScopedBinding storage
+} ScopedSymbolTable;
+
+static int initScopedSymbols(ScopedSymbolTable *t) {
+    memset(t, 0, sizeof(*t));
+    initObjectPool(&t->bindings, sizeof(ScopedBinding));
+    t->buckets = calloc(256, sizeof(ScopedBinding *));
+    t->frames = malloc(16 * sizeof(ScopeFrame));
+    if (!t->buckets || !t->frames)
+        return -1;
+    t->bucketMask = 255;
+    t->frameCapacity = 16;
+    memset(&t->frames[0], 0, sizeof(ScopeFrame));
+    return 0;
+}
+
+// Double the bucket array.  Frames are walked innermost first and each
+// scope's bindings newest first, appending to the chains, which rebuilds
+// every chain in innermost-first order.
+static int growScopeBuckets(ScopedSymbolTable *t) {
+    unsigned size = (t->bucketMask + 1) * 2;
+    ScopedBinding **buckets = calloc(size, sizeof(ScopedBinding *));
+    ScopedBinding **tails = calloc(size, sizeof(ScopedBinding *));
+    if (!buckets || !tails) {
+        free(buckets);
+        free(tails);
+        return -1;
+    }
+    for (int d = t->depth; d >= 0; d--) {
+        for (ScopedBinding *b = t->frames[d].bindings; b; b = b->sameScope) {
+            unsigned slot = b->nameId & (size - 1);
+            b->next = NULL;
+            if (tails[slot])
+                tails[slot]->next = b;
+            else
+                buckets[slot] = b;
+            tails[slot] = b;
+        }
+    }
+    free(tails);
+    free(t->buckets);
+    t->buckets = buckets;
+    t->bucketMask = size - 1;
+    return 0;
+}
+
+static int enterScope(ScopedSymbolTable *t) {
+    if (t->depth + 1 == t->frameCapacity) {
+        int capacity = t->frameCapacity * 2;
+        ScopeFrame *frames = realloc(t->frames, capacity * sizeof(ScopeFrame));
+        if (!frames)
+            return -1;
+        t->frames = frames;
+        t->frameCapacity = capacity;
+    }
+    ScopeFrame *frame = &t->frames[++t->depth];
+    frame->bindings = NULL;
+    frame->scope = ++t->scopes;
+    return 0;
+}
+
+// Close the innermost scope; a stray closer at file scope is ignored.
+static void exitScope(ScopedSymbolTable *t) {
+    if (t->depth == 0)
+        return;
+    ScopeFrame *frame = &t->frames[t->depth--];
+    for (ScopedBinding *b = frame->bindings, *older; b; b = older) {
+        older = b->sameScope;
+        t->buckets[b->nameId & t->bucketMask] = b->next;
+        t->live--;
+        poolPut(&t->bindings, b);
+    }
+}
+
+// Innermost visible binding of nameId, or NULL.
+static ScopedBinding *findBinding(const ScopedSymbolTable *t, unsigned nameId) {
+    ScopedBinding *b = t->buckets[nameId & t->bucketMask];
+    LEXSTATS(lexStats.scopeLookups++;)
+    while (b && b->nameId != nameId) {
+        b = b->next;
+        LEXSTATS(lexStats.scopeSteps++;)
+    }
+    return b;
+}
+
+// The declaration of nameId visible from the current scope, or NULL.
+ScopedSymbolEntry *lookupScopedSymbol(ScopedSymbolTable *t, unsigned nameId) {
+    ScopedBinding *b = findBinding(t, nameId);
+    return b ? &t->entries[b->entry] : NULL;
+}
+
+// Declare nameId (whose text is name) in the current scope; the first
+// declaration in a scope wins.
+static int declareScoped(ScopedSymbolTable *t, unsigned nameId, const char *name, const char *declType) {
+    ScopedBinding *shadowed = findBinding(t, nameId);
+    if (shadowed && shadowed->depth == t->depth)
+        return 0;
+    if (t->count == t->capacity) {
+        int capacity = t->capacity ? t->capacity * 2 : 64;
+        ScopedSymbolEntry *entries = realloc(t->entries, capacity * sizeof(ScopedSymbolEntry));
+        if (!entries)
+            return -1;
+        t->entries = entries;
+        t->capacity = capacity;
+    }
+    ScopedBinding *b = poolGet(&t->bindings);
+    if (!b)
+        return -1;
+    ScopeFrame *frame = &t->frames[t->depth];
+    ScopedSymbolEntry *entry = &t->entries[t->count];
+    fillSymbolEntry(&entry->symbol, nameId, name, declType);
+    entry->scope = frame->scope;
+    entry->depth = t->depth;
+
+    unsigned slot = nameId & t->bucketMask;
+    b->nameId = nameId;
+    b->depth = t->depth;
+    b->entry = t->count++;
+    b->next = t->buckets[slot];
+    t->buckets[slot] = b;
+    b->sameScope = frame->bindings;
+    frame->bindings = b;
+    if (++t->live > t->bucketMask + 1)
+        return growScopeBuckets(t);
+    return 0;
+}
+
+// LexerContext.declarationHook; hookData is the ScopedSymbolTable.
+static void declareScopedHook(LexerContext *ctx, unsigned nameId, const char *declType) {
+    declareScoped(ctx->hookData, nameId, internedString(&ctx->strings, nameId), declType);
+}
+
+void freeScopedSymbols(ScopedSymbolTable *t) {
+    free(t->entries);
+    free(t->buckets);
+    free(t->frames);
+    freeObjectPool(&t->bindings);
+    memset(t, 0, sizeof(*t));
+}
+
+// Default LanguageDescriptor.scopeDelta: '{' opens a scope, '}' closes one.
+int braceScopeDelta(const SourceBuffer *src, const TokenBuffer *tokens, size_t i, size_t *state) {
+    (void)state;
+    if (tokens->kinds[i] != TOKEN_OPERATOR || tokens->lengths[i] != 1)
+        return 0;
+    char c = src->data[tokens->offsets[i]];
+    return c == '{' ? 1 : c == '}' ? -1 : 0;
+}
+
+static void applyScopeDelta(ScopedSymbolTable *t, int delta) {
+    if (delta > 0)
+        enterScope(t);
+    else if (delta < 0)
+        exitScope(t);
+}
+
+/*
+ * generateSymbolTable with scopes, into t (freed with freeScopedSymbols).
+ * The collector runs up to and including each scope token, so
+ * declarations before it land in the enclosing scope (in Ruby that
+ * includes the name after "def"), and then the scope changes.  A scope
+ * token the collector swallowed as lookahead still counts.
+ */
+void generateScopedSymbolTable(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src,
+                               ScopedSymbolTable *t) {
+    int (*scopeDelta)(const SourceBuffer *, const TokenBuffer *, size_t, size_t *) =
+        lang->scopeDelta ? lang->scopeDelta : braceScopeDelta;
+    size_t state = 0;
+    TokenBuffer tokens;
+    ArenaMark mark = arenaMark(&ctx->scratch);
+    if (initScopedSymbols(t) != 0 ||
+        initTokenBufferIn(&tokens, &ctx->scratch, SYMBOL_WINDOW_TOKENS, 0) != 0)
+        return;
+    ctx->declarationHook = declareScopedHook;
+    ctx->hookData = t;
+    beginLexing(ctx, src);
+
+    int status = 0;
+    while (status == 0) {
+        status = lexTokens(ctx, lang, &tokens, SYMBOL_WINDOW_TOKENS);
+        size_t end = status != 0 ? tokens.count : tokens.count - 1;
+        size_t i = 0;
+        while (i < end) {
+            size_t b = i;
+            int delta = 0;
+            while (b < end && (delta = scopeDelta(src, &tokens, b, &state)) == 0)
+                b++;
+            size_t stop = b < end ? b + 1 : end;
+            size_t next = lang->collectSymbols(ctx, lang, &tokens, i, stop);
+            applyScopeDelta(t, delta);
+            for (size_t k = stop; k < next && k < tokens.count; k++)
+                applyScopeDelta(t, scopeDelta(src, &tokens, k, &state));
+            i = next;
+        }
+        size_t keep = i < tokens.count ? tokens.count - i : 0;
+        if (keep) {
+            memmove(tokens.kinds, tokens.kinds + i, keep);
+            memmove(tokens.offsets, tokens.offsets + i, keep * sizeof(size_t));
+            memmove(tokens.lengths, tokens.lengths + i, keep * sizeof(unsigned));
+        }
+        tokens.count = keep;
+    }
+    ctx->declarationHook = NULL;
+    ctx->hookData = NULL;
+    arenaRelease(&ctx->scratch, mark);
+}
+
+void printScopedSymbolTable(const ScopedSymbolTable *t, const LanguageDescriptor *lang) {
+    emitSymbolHeader(lang, 1);
+    for (int i = 0; i < t->count; i++) {
+        const ScopedSymbolEntry *entry = &t->entries[i];
+        emitSymbol(lang, i, &entry->symbol, entry->scope, entry->depth);
+    }
+}
+
+#endif
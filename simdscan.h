@@ -0,0 +1,307 @@
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+/*
+ * Bulk skipping kernels for the scanner's long runs: whitespace, line
+ * comment bodies, string bodies and block comment bodies.  Each kernel has
+ * a scalar version plus SSE2 and AVX2 versions that test 16 or 32 bytes at
+ * a time; lexKernels points at the best set the CPU supports, picked once
+ * by selectScanKernels().  Setting LEX_SIMD=scalar, sse2 or avx2 in the
+ * environment forces a particular set.
+ *
+ * Kernels that may cross line breaks report how many '\n' bytes they
+ * passed and the offset of the last one, counted inside the vector loop,
+ * so the caller can keep row/col exact without rescanning.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LEX_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+typedef struct {
+    int count;       // newlines passed
+    size_t last;     // offset of the last one (valid when count > 0)
+} LexLines;
+
+typedef struct {
+    const char *name;
+    // Length of the whitespace run at p (C-locale isspace bytes).
+    size_t (*skipSpace)(const unsigned char *p, size_t n, LexLines *lines);
+    // Offset of the first byte equal to c, or n.
+    size_t (*findByte)(const unsigned char *p, size_t n, unsigned char c);
+    // Offset of the first "*/", or n.
+    size_t (*findCommentEnd)(const unsigned char *p, size_t n, LexLines *lines);
+} LexScanKernels;
+
+static inline int isSpaceByte(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+static inline void noteNewline(LexLines *lines, size_t at) {
+    lines->count++;
+    lines->last = at;
+}
+
+/* ------------------------------------------------------------------ scalar */
+
+static size_t skipSpaceScalar(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i < n && isSpaceByte(p[i]); i++) {
+        if (p[i] == '\n')
+            noteNewline(lines, i);
+    }
+    return i;
+}
+
+static size_t findByteScalar(const unsigned char *p, size_t n, unsigned char c) {
+    const unsigned char *hit = memchr(p, c, n);
+    return hit ? (size_t)(hit - p) : n;
+}
+
+static size_t findCommentEndScalar(const unsigned char *p, size_t n, LexLines *lines) {
+    for (size_t i = 0; i + 1 < n; i++) {
+        if (p[i] == '*' && p[i + 1] == '/')
+            return i;
+        if (p[i] == '\n')
+            noteNewline(lines, i);
+    }
+    if (n > 0 && p[n - 1] == '\n')
+        noteNewline(lines, n - 1);
+    return n;
+}
+
+static const LexScanKernels scalarKernels = {
+    "scalar", skipSpaceScalar, findByteScalar, findCommentEndScalar
+};
+
+#ifdef LEX_HAVE_X86_SIMD
+
+// Fold the newline bits of one block into lines; mask covers only the
+// bytes that were actually skipped.
+static inline void countNewlines(LexLines *lines, unsigned mask, size_t base) {
+    if (mask) {
+        lines->count += __builtin_popcount(mask);
+        lines->last = base + 31 - __builtin_clz(mask);
+    }
+}
+
+// Bits below the first set bit of stop (all bits if stop is 0).
+static inline unsigned maskBefore(unsigned stop, int width) {
+    if (!stop)
+        return width == 32 ? 0xffffffffu : (1u << width) - 1;
+    return (stop & -stop) - 1;
+}
+
+// Run a scalar kernel on the tail at p + base and merge its line count.
+static inline size_t scalarTail(size_t (*kernel)(const unsigned char *, size_t, LexLines *),
+                                const unsigned char *p, size_t base, size_t n, LexLines *lines) {
+    LexLines tail = { 0, 0 };
+    size_t r = kernel(p + base, n - base, &tail);
+    if (tail.count) {
+        lines->count += tail.count;
+        lines->last = base + tail.last;
+    }
+    return base + r;
+}
+
+/* -------------------------------------------------------------------- SSE2 */
+
+__attribute__((target("sse2")))
+static inline unsigned spaceMask16(__m128i v) {
+    // ' ' or '\t'..'\r': subtract '\t' and test (unsigned) <= 4.
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    __m128i blank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(ctrl, blank));
+}
+
+__attribute__((target("sse2")))
+static size_t skipSpaceSSE2(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned stop = ~spaceMask16(v) & 0xffff;
+        unsigned nl = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        countNewlines(lines, nl & maskBefore(stop, 16), i);
+        if (stop)
+            return i + __builtin_ctz(stop);
+    }
+    return scalarTail(skipSpaceScalar, p, i, n, lines);
+}
+
+__attribute__((target("sse2")))
+static size_t findByteSSE2(const unsigned char *p, size_t n, unsigned char c) {
+    __m128i needle = _mm_set1_epi8((char)c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned hit = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (hit)
+            return i + __builtin_ctz(hit);
+    }
+    return i + findByteScalar(p + i, n - i, c);
+}
+
+__attribute__((target("sse2")))
+static size_t findCommentEndSSE2(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    // Needs one byte of lookahead for the '/' after each '*'.
+    for (; i + 17 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(p + i + 1));
+        unsigned stop = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('*')), _mm_cmpeq_epi8(next, _mm_set1_epi8('/'))));
+        unsigned nl = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        countNewlines(lines, nl & maskBefore(stop, 16), i);
+        if (stop)
+            return i + __builtin_ctz(stop);
+    }
+    return scalarTail(findCommentEndScalar, p, i, n, lines);
+}
+
+static const LexScanKernels sse2Kernels = {
+    "sse2", skipSpaceSSE2, findByteSSE2, findCommentEndSSE2
+};
+
+/* -------------------------------------------------------------------- AVX2 */
+
+__attribute__((target("avx2")))
+static inline unsigned spaceMask32(__m256i v) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    __m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    __m256i blank = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return (unsigned)_mm256_movemask_epi8(_mm256_or_si256(ctrl, blank));
+}
+
+__attribute__((target("avx2")))
+static size_t skipSpaceAVX2(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        unsigned stop = ~spaceMask32(v);
+        unsigned nl = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        countNewlines(lines, nl & maskBefore(stop, 32), i);
+        if (stop)
+            return i + __builtin_ctz(stop);
+    }
+    return scalarTail(skipSpaceScalar, p, i, n, lines);
+}
+
+__attribute__((target("avx2")))
+static size_t findByteAVX2(const unsigned char *p, size_t n, unsigned char c) {
+    __m256i needle = _mm256_set1_epi8((char)c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        unsigned hit = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+        if (hit)
+            return i + __builtin_ctz(hit);
+    }
+    return i + findByteScalar(p + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static size_t findCommentEndAVX2(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i + 33 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(p + i + 1));
+        unsigned stop = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(next, _mm256_set1_epi8('/'))));
+        unsigned nl = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        countNewlines(lines, nl & maskBefore(stop, 32), i);
+        if (stop)
+            return i + __builtin_ctz(stop);
+    }
+    return scalarTail(findCommentEndScalar, p, i, n, lines);
+}
+
+static const LexScanKernels avx2Kernels = {
+    "avx2", skipSpaceAVX2, findByteAVX2, findCommentEndAVX2
+};
+
+#endif
+
+const LexScanKernels *lexKernels = &scalarKernels;
+
+/*
+ * Entry points used by the scanner.  Most runs are a byte or two (the space
+ * between tokens, a short string), where an indirect call costs more than
+ * it saves, so the first LEX_BULK_MIN bytes are tested inline and only
+ * longer runs are handed to the selected kernel.
+ */
+#define LEX_BULK_MIN 16
+
+static inline size_t lexSkipSpace(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i < n && i < LEX_BULK_MIN; i++) {
+        if (!isSpaceByte(p[i]))
+            return i;
+        if (p[i] == '\n')
+            noteNewline(lines, i);
+    }
+    if (i == n)
+        return n;
+    LexLines rest = { 0, 0 };
+    size_t r = lexKernels->skipSpace(p + i, n - i, &rest);
+    if (rest.count) {
+        lines->count += rest.count;
+        lines->last = i + rest.last;
+    }
+    return i + r;
+}
+
+static inline size_t lexFindByte(const unsigned char *p, size_t n, unsigned char c) {
+    size_t i = 0;
+    for (; i < n && i < LEX_BULK_MIN; i++) {
+        if (p[i] == c)
+            return i;
+    }
+    return i == n ? n : i + lexKernels->findByte(p + i, n - i, c);
+}
+
+// Offset of the first "*/" at p, or n; newlines before it go in lines.
+static inline size_t lexFindCommentEnd(const unsigned char *p, size_t n, LexLines *lines) {
+    size_t i = 0;
+    for (; i + 1 < n && i < LEX_BULK_MIN; i++) {
+        if (p[i] == '*' && p[i + 1] == '/')
+            return i;
+        if (p[i] == '\n')
+            noteNewline(lines, i);
+    }
+    if (i + 1 >= n) {
+        if (i < n && p[i] == '\n')
+            noteNewline(lines, i);
+        return n;
+    }
+    LexLines rest = { 0, 0 };
+    size_t r = lexKernels->findCommentEnd(p + i, n - i, &rest);
+    if (rest.count) {
+        lines->count += rest.count;
+        lines->last = i + rest.last;
+    }
+    return i + r;
+}
+
+// Pick the widest kernel set the CPU supports, unless LEX_SIMD overrides it.
+void selectScanKernels(void) {
+    const char *forced = getenv("LEX_SIMD");
+    lexKernels = &scalarKernels;
+#ifdef LEX_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (forced && strcmp(forced, "scalar") == 0)
+        return;
+    if (__builtin_cpu_supports("avx2") && !(forced && strcmp(forced, "sse2") == 0))
+        lexKernels = &avx2Kernels;
+    else if (__builtin_cpu_supports("sse2"))
+        lexKernels = &sse2Kernels;
+#else
+    (void)forced;
+#endif
+}
+
+#endif
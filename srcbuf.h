@@ -0,0 +1,131 @@
+#ifndef SRCBUF_H
+#define SRCBUF_H
+
+/*
+ * In-memory source buffer shared by the scanners.
+ *
+ * Regular files are memory-mapped so getNextToken can walk a pointer over
+ * the bytes instead of going through fgetc/ungetc for every character.
+ * Anything that cannot be mapped (stdin, pipes, empty files, platforms
+ * without mmap) is read into a heap buffer instead, so the scanners only
+ * ever see one interface.  Lexemes are (offset, length) views into this
+ * buffer, so the buffer must stay open while tokens are in use.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+typedef struct {
+    const char *data;
+    size_t len;
+    size_t pos;
+    int mapped;     // 1 if data is an mmap'd region, 0 if it was malloc'd
+} SourceBuffer;
+
+// Read the whole stream into a heap buffer (stdin, pipes, fallback path).
+static int srcReadStream(SourceBuffer *src, FILE *fp) {
+    size_t cap = 1 << 16, len = 0, n;
+    char *buf = malloc(cap);
+    if (!buf)
+        return -1;
+    while ((n = fread(buf + len, 1, cap - len, fp)) > 0) {
+        len += n;
+        if (len == cap) {
+            char *grown = realloc(buf, cap *= 2);
+            if (!grown) { free(buf); return -1; }
+            buf = grown;
+        }
+    }
+    src->data = buf;
+    src->len = len;
+    src->pos = 0;
+    src->mapped = 0;
+    return 0;
+}
+
+// Open path ("-" means stdin).  Returns 0 on success, -1 on failure.
+static int srcOpen(SourceBuffer *src, const char *path) {
+    if (strcmp(path, "-") == 0)
+        return srcReadStream(src, stdin);
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            close(fd);
+            src->data = p;
+            src->len = (size_t)st.st_size;
+            src->pos = 0;
+            src->mapped = 1;
+            return 0;
+        }
+    }
+    close(fd);
+#endif
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return -1;
+    int rc = srcReadStream(src, fp);
+    fclose(fp);
+    return rc;
+}
+
+static void srcClose(SourceBuffer *src) {
+#ifndef _WIN32
+    if (src->mapped) {
+        munmap((void *)src->data, src->len);
+        src->data = NULL;
+        return;
+    }
+#endif
+    free((void *)src->data);
+    src->data = NULL;
+}
+
+static inline int srcGet(SourceBuffer *src) {
+    return src->pos < src->len ? (unsigned char)src->data[src->pos++] : EOF;
+}
+
+static inline void srcUnget(SourceBuffer *src, int c) {
+    if (c != EOF)
+        src->pos--;
+}
+
+static inline void srcRewind(SourceBuffer *src) {
+    src->pos = 0;
+}
+
+// Compare a lexeme view against a NUL-terminated string.
+static inline int srcViewEquals(const SourceBuffer *src, size_t offset, int length, const char *s) {
+    return strlen(s) == (size_t)length && memcmp(src->data + offset, s, (size_t)length) == 0;
+}
+
+// Copy a lexeme view into buf as a NUL-terminated string, truncating if needed.
+static inline char *srcCopyView(const SourceBuffer *src, size_t offset, int length, char *buf, size_t size) {
+    size_t n = (size_t)length < size ? (size_t)length : size - 1;
+    memcpy(buf, src->data + offset, n);
+    buf[n] = '\0';
+    return buf;
+}
+
+// Convenience wrappers for Token structs carrying (offset, length) lexemes.
+#define TOKEN_IS(src, tok, s) srcViewEquals((src), (tok).offset, (tok).length, (s))
+#define TOKEN_TEXT(src, tok, buf) srcCopyView((src), (tok).offset, (tok).length, (buf), sizeof(buf))
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+/*
+ * Streaming mode: lex stdin, a pipe or any other stream in fixed-size
+ * reads, with memory bounded by the read size and the live symbol set
+ * rather than by the length of the input.
+ *
+ * The scanners see a SourceBuffer over a window of the input.  Tokens are
+ * scanned with scanToken (lexer.h), which stops at the window's end unless
+ * the input is exhausted: a token that straddles two reads is left half
+ * scanned, and the scan carries on from the same byte, in the same DFA
+ * state, once the next read has been appended.  So no byte is scanned
+ * twice, however long the comment, string or whitespace run it is in.
+ *
+ * Before each read the window is squeezed down to what is still needed:
+ * the lexemes of buffered tokens, the unfinished lexeme, and of each gap
+ * between them only the first byte that is not whitespace (the byte
+ * peekCharAfter looks for).  Whitespace and comments are dropped as soon
+ * as they are scanned, so the window only grows past twice the read size
+ * for lexemes that do not fit in it.
+ *
+ * Symbols are collected a window of tokens at a time as in
+ * generateSymbolTable and printed as soon as they are first declared; the
+ * table is kept only to drop later declarations of the same name.  Tokens
+ * are printed as they are lexed.  Both outputs are identical to a run over
+ * the whole input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "tokbuf.h"
+
+#define STREAM_READ_SIZE (1 << 16)   // default bytes per read
+
+#ifndef STREAM_WINDOW_TOKENS
+#define STREAM_WINDOW_TOKENS 4096    // at least 3
+#endif
+
+typedef struct {
+    FILE *fp;
+    char *window;
+    size_t capacity, readSize;
+    SourceBuffer src;    // view over window[0..src.len)
+    int eof;             // nothing left to read
+    TokenScan scan;      // the token being scanned
+    int scanning;        // scan is waiting for more input
+} InputStream;
+
+static int openInputStream(InputStream *in, FILE *fp, size_t readSize) {
+    memset(in, 0, sizeof(*in));
+    in->fp = fp;
+    in->readSize = readSize ? readSize : STREAM_READ_SIZE;
+    in->capacity = 2 * in->readSize;
+    if (!(in->window = malloc(in->capacity)))
+        return -1;
+    in->src.data = in->window;
+    return 0;
+}
+
+static void closeInputStream(InputStream *in) {
+    free(in->window);
+    in->window = NULL;
+}
+
+// Move window[from..to) down to window[at..), keeping only its first byte
+// that is not whitespace.  Returns the number of bytes kept.
+static size_t squeezeGap(char *window, size_t at, size_t from, size_t to) {
+    while (from < to && isSpaceByte((unsigned char)window[from]))
+        from++;
+    if (from == to)
+        return 0;
+    window[at] = window[from];
+    return 1;
+}
+
+// Squeeze the window down to the lexemes of tokens (NULL for none) and of
+// the waiting scan, and append the next read.  Returns 0, or -1 if out of
+// memory.
+static int refillInputStream(InputStream *in, TokenBuffer *tokens) {
+    char *window = in->window;
+    size_t live = 0, end = 0;
+    for (size_t i = 0; tokens && i < tokens->count; i++) {
+        if (i > 0)
+            live += squeezeGap(window, live, end, tokens->offsets[i]);
+        end = tokens->offsets[i] + tokens->lengths[i];
+        memmove(window + live, window + tokens->offsets[i], tokens->lengths[i]);
+        tokens->offsets[i] = live;
+        live += tokens->lengths[i];
+    }
+    size_t pending = in->scan.token.offset;
+    if (tokens && tokens->count)
+        live += squeezeGap(window, live, end, pending);
+    memmove(window + live, window + pending, in->src.len - pending);
+    in->scan.token.offset = live;
+    live += in->src.len - pending;
+
+    if (live + in->readSize > in->capacity) {
+        size_t capacity = in->capacity;
+        while (live + in->readSize > capacity)
+            capacity *= 2;
+        if (!(window = realloc(in->window, capacity)))
+            return -1;
+        in->window = window;
+        in->capacity = capacity;
+    }
+    size_t n = fread(window + live, 1, in->readSize, in->fp);
+    if (n == 0)
+        in->eof = 1;
+    in->src.data = window;
+    in->src.len = live + n;
+    in->src.pos = live;
+    return 0;
+}
+
+// Lex the next token as far as the window goes.  Returns 1 with the token,
+// or 0 if the window ran out first; the scan then waits in in->scan and
+// goes on from where it stopped after a refill.
+static int lexStreamToken(LexerContext *ctx, const LanguageDescriptor *lang, InputStream *in, Token *token) {
+    if (!in->scanning) {
+        beginTokenScan(ctx, &in->scan);
+        in->scanning = 1;
+    }
+    if (!scanToken(ctx, lang, &in->scan, !in->eof))
+        return 0;
+    in->scanning = 0;
+    *token = in->scan.token;
+    return 1;
+}
+
+// printTokens() over a stream.  Returns 0, or -1 if out of memory.
+int printTokensStreaming(LexerContext *ctx, const LanguageDescriptor *lang, FILE *fp, size_t readSize) {
+    InputStream in;
+    if (openInputStream(&in, fp, readSize) != 0)
+        return -1;
+    beginLexing(ctx, &in.src);
+    emitTokenHeader();
+    for (;;) {
+        Token token;
+        if (!lexStreamToken(ctx, lang, &in, &token)) {
+            if (refillInputStream(&in, NULL) != 0)
+                break;
+            continue;
+        }
+        if (token.kind == TOKEN_EOF)
+            break;
+        emitToken(token.kind, in.src.data + token.offset, (size_t)token.length, token.row, token.col);
+    }
+    int status = in.eof ? 0 : -1;
+    closeInputStream(&in);
+    return status;
+}
+
+/*
+ * generateSymbolTable and printSymbolTable over a stream, printing each
+ * row as soon as its symbol is found.  A window is handed to the collector
+ * without its last two tokens while more input may follow: one is the
+ * collector's lookahead, and the other keeps peekCharAfter from running
+ * off the end of the window.  Returns 0, or -1 if out of memory.
+ */
+int printSymbolsStreaming(LexerContext *ctx, const LanguageDescriptor *lang, FILE *fp, size_t readSize) {
+    InputStream in;
+    TokenBuffer tokens;
+    if (openInputStream(&in, fp, readSize) != 0)
+        return -1;
+    initTokenBuffer(&tokens, 0);
+    beginLexing(ctx, &in.src);
+    emitSymbolHeader(lang, 0);
+
+    int status = 0, done = 0, printed = 0;
+    while (!done && status == 0) {
+        while (tokens.count < STREAM_WINDOW_TOKENS) {
+            Token token;
+            if (!lexStreamToken(ctx, lang, &in, &token)) {
+                if (refillInputStream(&in, &tokens) != 0) {
+                    status = -1;
+                    break;
+                }
+                continue;
+            }
+            if (token.kind == TOKEN_EOF) {
+                done = 1;
+                break;
+            }
+            if (pushToken(&tokens, &token) != 0) {
+                status = -1;
+                break;
+            }
+        }
+        if (status != 0)
+            break;
+
+        size_t end = done ? tokens.count : tokens.count - 2;
+        size_t next = lang->collectSymbols(ctx, lang, &tokens, 0, end);
+        for (; printed < ctx->symbols.count; printed++)
+            emitSymbol(lang, printed, &ctx->symbols.entries[printed], -1, 0);
+        size_t keep = next < tokens.count ? tokens.count - next : 0;
+        if (keep) {
+            memmove(tokens.kinds, tokens.kinds + next, keep);
+            memmove(tokens.offsets, tokens.offsets + next, keep * sizeof(size_t));
+            memmove(tokens.lengths, tokens.lengths + next, keep * sizeof(unsigned));
+        }
+        tokens.count = keep;
+    }
+    freeTokenBuffer(&tokens);
+    closeInputStream(&in);
+    return status;
+}
+
+#endif
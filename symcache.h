@@ -0,0 +1,398 @@
+#ifndef SYMCACHE_H
+#define SYMCACHE_H
+
+/*
+ * On-disk cache of symbol tables (and optionally token streams), keyed by
+ * the content of the input.
+ *
+ * A cache file is named after a 64-bit hash of the input bytes and the
+ * lexer key: a hash of LEXER_VERSION, the language's name, comment,
+ * directive and identifier rules and its keyword list.  Changing any of
+ * those gives every input a new key, so stale entries are never looked at
+ * again; the header repeats both values, plus the input length, and is
+ * checked on every hit.
+ *
+ * The file is written once and read in place.  On a hit it is mapped
+ * (srcOpen) and the symbol table is rebuilt straight from the fixed-size
+ * records and string section without lexing anything.  A token section, if
+ * present, is laid out exactly like a TokenBuffer's arrays, so it is used
+ * directly from the mapping.  Files are written under a temporary name
+ * and renamed into place, so concurrent runs sharing a cache directory
+ * only ever see complete entries.
+ *
+ * The format is native-endian and assumes the writer's size_t; the header
+ * records both, and a file from another platform is simply a miss.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "lexer.h"
+#include "tokbuf.h"
+#include "bytebuf.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#define SYMCACHE_MAGIC "LEXCACHE"
+#define SYMCACHE_FORMAT 1
+#define SYMCACHE_HAS_TOKENS 1
+
+typedef struct {
+    char magic[8];
+    uint32_t format;           // SYMCACHE_FORMAT
+    uint32_t flags;            // SYMCACHE_HAS_TOKENS
+    uint64_t lexerKey;
+    uint64_t contentHash;
+    uint64_t inputLength;
+    uint32_t byteOrder;        // 0x01020304 as written
+    uint32_t sizeofSizeT;
+    uint32_t symbolCount;
+    uint32_t stringBytes;
+    uint64_t tokenCount;
+    uint64_t symbolsOffset, stringsOffset;
+    uint64_t kindsOffset, offsetsOffset, lengthsOffset, positionsOffset;
+} CacheHeader;
+
+typedef struct {
+    int32_t hash;
+    uint32_t name, type, size;   // offsets into the string section
+} CachedSymbol;
+
+/* ----------------------------------------------------------------- hash */
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ull
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    return rotl64(acc, 31) * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxhMerge(uint64_t acc, uint64_t val) {
+    acc ^= xxhRound(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+// XXH64 of data[0..len): four independent lanes over 32-byte stripes, so
+// it runs at several bytes per cycle.
+uint64_t contentHash64(const void *data, size_t len, uint64_t seed) {
+    const unsigned char *p = data, *end = p + len;
+    uint64_t h;
+    if (len >= 32) {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2, v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed, v4 = seed - XXH_PRIME64_1;
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxhMerge(h, v1);
+        h = xxhMerge(h, v2);
+        h = xxhMerge(h, v3);
+        h = xxhMerge(h, v4);
+    } else {
+        h = seed + XXH_PRIME64_5;
+    }
+    h += len;
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxhRound(0, read64(p));
+        h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        h ^= read32(p) * XXH_PRIME64_1;
+        h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= *p * XXH_PRIME64_5;
+        h = rotl64(h, 11) * XXH_PRIME64_1;
+    }
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t hashString(uint64_t h, const char *s) {
+    return contentHash64(s, strlen(s) + 1, h);
+}
+
+// Everything that decides what a language's tokens and symbols are.
+uint64_t lexerKey(const LanguageDescriptor *lang) {
+    uint64_t h = contentHash64("lexer", 5, LEXER_VERSION);
+    h = hashString(h, lang->name);
+    h = hashString(h, lang->lineComment);
+    h = hashString(h, lang->identChars);
+    h = hashString(h, lang->variableSigils);
+    h = contentHash64(&lang->twoCharOperators, sizeof(lang->twoCharOperators), h);
+    h = contentHash64(&lang->blockComments, sizeof(lang->blockComments), h);
+    h = contentHash64(&lang->directives, sizeof(lang->directives), h);
+    for (int i = 0; i < lang->numKeywords; i++)
+        h = hashString(h, lang->keywords[i]);
+    return h;
+}
+
+/* ---------------------------------------------------------------- files */
+
+typedef struct {
+    SourceBuffer file;         // the mapped cache file
+    const CacheHeader *header;
+} CacheEntry;
+
+static void cachePath(char *path, size_t size, const char *dir, uint64_t contentHash, uint64_t key) {
+    snprintf(path, size, "%s/%016llx-%016llx.lxc", dir, (unsigned long long)contentHash,
+             (unsigned long long)key);
+}
+
+static int sectionFits(const CacheEntry *entry, uint64_t offset, uint64_t count, size_t size) {
+    return offset <= entry->file.len && count <= (entry->file.len - offset) / size;
+}
+
+void closeCacheEntry(CacheEntry *entry) {
+    if (entry->file.data)
+        srcClose(&entry->file);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/*
+ * Look up the cache entry for src.  Returns 0 on a hit (the entry must be
+ * closed with closeCacheEntry), -1 on a miss.  With needTokens only an
+ * entry that stored the token stream counts as a hit.
+ */
+int openCacheEntry(CacheEntry *entry, const char *dir, const LanguageDescriptor *lang,
+                   const SourceBuffer *src, int needTokens) {
+    memset(entry, 0, sizeof(*entry));
+    uint64_t contentHash = contentHash64(src->data, src->len, 0), key = lexerKey(lang);
+    char path[4096];
+    cachePath(path, sizeof(path), dir, contentHash, key);
+    if (srcOpen(&entry->file, path) != 0) {
+        entry->file.data = NULL;
+        return -1;
+    }
+
+    const CacheHeader *h = (const CacheHeader *)entry->file.data;
+    entry->header = h;
+    int ok = entry->file.len >= sizeof(CacheHeader) && memcmp(h->magic, SYMCACHE_MAGIC, 8) == 0 &&
+             h->format == SYMCACHE_FORMAT && h->byteOrder == 0x01020304 &&
+             h->sizeofSizeT == sizeof(size_t) && h->lexerKey == key && h->contentHash == contentHash &&
+             h->inputLength == src->len &&
+             sectionFits(entry, h->symbolsOffset, h->symbolCount, sizeof(CachedSymbol)) &&
+             sectionFits(entry, h->stringsOffset, h->stringBytes, 1) && h->stringBytes > 0 &&
+             entry->file.data[h->stringsOffset + h->stringBytes - 1] == '\0';
+    if (ok && (h->flags & SYMCACHE_HAS_TOKENS)) {
+        ok = sectionFits(entry, h->kindsOffset, h->tokenCount, 1) &&
+             sectionFits(entry, h->offsetsOffset, h->tokenCount, sizeof(size_t)) &&
+             sectionFits(entry, h->lengthsOffset, h->tokenCount, sizeof(unsigned)) &&
+             sectionFits(entry, h->positionsOffset, h->tokenCount, sizeof(TokenPos));
+    }
+    if (ok && needTokens && !(h->flags & SYMCACHE_HAS_TOKENS))
+        ok = 0;
+    if (!ok) {
+        closeCacheEntry(entry);
+        return -1;
+    }
+    return 0;
+}
+
+// Rebuild ctx's symbol table from a cache entry.  The names are interned,
+// so the entry can be closed afterwards.  Returns 0, or -1 if the entry is
+// damaged or memory runs out.
+int loadCachedSymbols(LexerContext *ctx, const CacheEntry *entry) {
+    const CacheHeader *h = entry->header;
+    const CachedSymbol *symbols = (const CachedSymbol *)(entry->file.data + h->symbolsOffset);
+    const char *strings = entry->file.data + h->stringsOffset;
+    for (uint32_t i = 0; i < h->symbolCount; i++) {
+        const CachedSymbol *s = &symbols[i];
+        if (s->name >= h->stringBytes || s->type >= h->stringBytes || s->size >= h->stringBytes)
+            return -1;
+        const char *name = strings + s->name;
+        int added;
+        unsigned id = internString(&ctx->strings, name, strlen(name));
+        int idx = id ? internSymbol(&ctx->symbols, id, &added) : -1;
+        if (idx < 0)
+            return -1;
+        if (!added)
+            continue;
+        SymbolTableEntry *e = &ctx->symbols.entries[idx];
+        e->name = internedString(&ctx->strings, id);
+        e->type = intern(&ctx->strings, strings + s->type);
+        e->size = strings[s->size] ? intern(&ctx->strings, strings + s->size) : "";
+        e->hash = s->hash;
+    }
+    return 0;
+}
+
+// The cached token stream, viewed in place.  Valid while the entry is open.
+TokenBuffer cachedTokens(const CacheEntry *entry) {
+    const CacheHeader *h = entry->header;
+    TokenBuffer tokens;
+    memset(&tokens, 0, sizeof(tokens));
+    tokens.kinds = (unsigned char *)(entry->file.data + h->kindsOffset);
+    tokens.offsets = (size_t *)(entry->file.data + h->offsetsOffset);
+    tokens.lengths = (unsigned *)(entry->file.data + h->lengthsOffset);
+    tokens.positions = (TokenPos *)(entry->file.data + h->positionsOffset);
+    tokens.count = tokens.capacity = (size_t)h->tokenCount;
+    tokens.withPositions = 1;
+    return tokens;
+}
+
+// Offset of s in the string section, adding it unless it is the same
+// pointer as one of the last few (types repeat a lot).
+static uint32_t cacheString(ByteBuffer *strings, const char *s, const char **recent, uint32_t *recentAt,
+                            int *next) {
+    for (int i = 0; i < 8; i++) {
+        if (recent[i] == s)
+            return recentAt[i];
+    }
+    uint32_t at = (uint32_t)strings->len;
+    if (appendBytes(strings, s, strlen(s) + 1) != 0)
+        return UINT32_MAX;
+    recent[*next] = s;
+    recentAt[*next] = at;
+    *next = (*next + 1) % 8;
+    return at;
+}
+
+/*
+ * Write ctx's symbol table (and the token stream, if tokens is not NULL;
+ * it needs positions) as the cache entry for src.  Returns 0, or -1 on
+ * failure; a failed store just means a later miss.
+ */
+int storeCacheEntry(const LexerContext *ctx, const char *dir, const LanguageDescriptor *lang,
+                    const SourceBuffer *src, const TokenBuffer *tokens) {
+    const SymbolTable *table = &ctx->symbols;
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SYMCACHE_MAGIC, 8);
+    h.format = SYMCACHE_FORMAT;
+    h.lexerKey = lexerKey(lang);
+    h.contentHash = contentHash64(src->data, src->len, 0);
+    h.inputLength = src->len;
+    h.byteOrder = 0x01020304;
+    h.sizeofSizeT = sizeof(size_t);
+    h.symbolCount = (uint32_t)table->count;
+
+    ByteBuffer strings = { 0 }, out = { 0 };
+    CachedSymbol *symbols = malloc((table->count ? table->count : 1) * sizeof(CachedSymbol));
+    const char *recent[8] = { 0 };
+    uint32_t recentAt[8] = { 0 };
+    int next = 0, status = -1;
+    if (!symbols || appendBytes(&strings, "", 1) != 0)
+        goto done;
+    for (int i = 0; i < table->count; i++) {
+        const SymbolTableEntry *e = &table->entries[i];
+        symbols[i].hash = e->hash;
+        symbols[i].name = cacheString(&strings, e->name, recent, recentAt, &next);
+        symbols[i].type = cacheString(&strings, e->type, recent, recentAt, &next);
+        symbols[i].size = e->size[0] ? cacheString(&strings, e->size, recent, recentAt, &next) : 0;
+        if (symbols[i].name == UINT32_MAX || symbols[i].type == UINT32_MAX || symbols[i].size == UINT32_MAX)
+            goto done;
+    }
+    h.stringBytes = (uint32_t)strings.len;
+
+    // Lay out the sections after the header, each 8-byte aligned.
+    if (appendBytes(&out, &h, sizeof(h)) != 0 || alignBytes(&out) != 0)
+        goto done;
+    h.symbolsOffset = out.len;
+    if (appendBytes(&out, symbols, table->count * sizeof(CachedSymbol)) != 0 || alignBytes(&out) != 0)
+        goto done;
+    h.stringsOffset = out.len;
+    if (appendBytes(&out, strings.data, strings.len) != 0 || alignBytes(&out) != 0)
+        goto done;
+    if (tokens && tokens->withPositions) {
+        size_t n = tokens->count;
+        h.flags |= SYMCACHE_HAS_TOKENS;
+        h.tokenCount = n;
+        h.kindsOffset = out.len;
+        if (appendBytes(&out, tokens->kinds, n) != 0 || alignBytes(&out) != 0)
+            goto done;
+        h.offsetsOffset = out.len;
+        if (appendBytes(&out, tokens->offsets, n * sizeof(size_t)) != 0 || alignBytes(&out) != 0)
+            goto done;
+        h.lengthsOffset = out.len;
+        if (appendBytes(&out, tokens->lengths, n * sizeof(unsigned)) != 0 || alignBytes(&out) != 0)
+            goto done;
+        h.positionsOffset = out.len;
+        if (appendBytes(&out, tokens->positions, n * sizeof(TokenPos)) != 0)
+            goto done;
+    }
+    memcpy(out.data, &h, sizeof(h));
+
+    char path[4096], tmp[4200];
+    cachePath(path, sizeof(path), dir, h.contentHash, h.lexerKey);
+    // Unique per process and context (batch workers can store the same
+    // content at once, each with its own context).
+#ifndef _WIN32
+    snprintf(tmp, sizeof(tmp), "%s.%ld.%p.tmp", path, (long)getpid(), (const void *)ctx);
+#else
+    snprintf(tmp, sizeof(tmp), "%s.%p.tmp", path, (const void *)ctx);
+#endif
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp)
+        goto done;
+    size_t written = fwrite(out.data, 1, out.len, fp);
+    if (fclose(fp) != 0 || written != out.len) {
+        remove(tmp);
+        goto done;
+    }
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (rename(tmp, path) != 0) {
+        remove(tmp);
+        goto done;
+    }
+    status = 0;
+
+done:
+    free(symbols);
+    free(strings.data);
+    free(out.data);
+    return status;
+}
+
+// generateSymbolTable through the cache in dir.  Returns 1 on a hit, 0 on
+// a miss (the table is generated and stored).
+int cachedSymbolTable(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src, const char *dir) {
+    CacheEntry entry;
+    if (openCacheEntry(&entry, dir, lang, src, 0) == 0) {
+        int status = loadCachedSymbols(ctx, &entry);
+        closeCacheEntry(&entry);
+        if (status == 0)
+            return 1;
+        freeSymbolTable(&ctx->symbols);
+    }
+    generateSymbolTable(ctx, lang, src);
+    storeCacheEntry(ctx, dir, lang, src, NULL);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef SYMTAB_H
+#define SYMTAB_H
+
+/*
+ * Symbol table shared by the front ends.
+ *
+ * Entries are kept in a growable array in insertion order (that is the
+ * order printSymbolTable reports them in).  Names and types are interned in
+ * the lexer context's pool (intern.h, lexctx.h), so an entry is a few
+ * pointers and names of any length are kept whole.  Because a name's intern id is already a small
+ * dense integer, the index is just an array from id to entry: insert and
+ * lookup are one load, with no hashing or string compare past the one the
+ * interner did.  Both arrays grow on demand; there is no fixed symbol limit.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "intern.h"
+
+#define SYMBOL_HASH_BUCKETS 100   // range of the Hash column printed for each entry
+
+typedef struct {
+    int hash;            // calculateHash(name), kept for display
+    const char *name;    // interned in the context's pool, any length
+    const char *type;    // interned declared type, "function", or "variable" depending on the language
+    const char *size;    // not tracked by any front end yet; left blank
+    unsigned nameId;     // pool id of name
+} SymbolTableEntry;
+
+typedef struct {
+    SymbolTableEntry *entries;    // insertion order
+    int count, capacity;
+    int *byId;                    // entry index + 1 by name id, 0 = none
+    unsigned idCapacity;
+} SymbolTable;
+
+// Hash column shown for a name: the legacy hash (hashfn.h) folded into
+// SYMBOL_HASH_BUCKETS.  The old code did this in int arithmetic, which
+// overflowed; the value it wrapped to is reproduced from the unsigned hash
+// so the column does not change.
+int calculateHash(const char* str) {
+    unsigned h = hashLegacy(str, strlen(str));
+    // abs(hash % buckets) of the wrapped signed hash.
+    return (int)(h <= INT_MAX ? h % SYMBOL_HASH_BUCKETS : (0u - h) % SYMBOL_HASH_BUCKETS);
+}
+
+// Make room in the index for ids below nameId + 1.
+static int growSymbolIndex(SymbolTable *table, unsigned nameId) {
+    unsigned capacity = table->idCapacity ? table->idCapacity : 256;
+    while (capacity <= nameId)
+        capacity *= 2;
+    int *byId = realloc(table->byId, capacity * sizeof(int));
+    if (!byId)
+        return -1;
+    memset(byId + table->idCapacity, 0, (capacity - table->idCapacity) * sizeof(int));
+    table->byId = byId;
+    table->idCapacity = capacity;
+    return 0;
+}
+
+// Find the name with this id in table, appending a blank entry for it if
+// it is not there.  Returns the entry index (-1 if out of memory); *added
+// says which case.
+static int internSymbol(SymbolTable *table, unsigned nameId, int *added) {
+    *added = 0;
+    if (nameId >= table->idCapacity && growSymbolIndex(table, nameId) != 0)
+        return -1;
+    if (table->byId[nameId] != 0)
+        return table->byId[nameId] - 1;
+
+    if (table->count == table->capacity) {
+        int capacity = table->capacity ? table->capacity * 2 : 64;
+        SymbolTableEntry *entries = realloc(table->entries, capacity * sizeof(SymbolTableEntry));
+        if (!entries)
+            return -1;
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+
+    SymbolTableEntry *entry = &table->entries[table->count];
+    entry->nameId = nameId;
+    table->byId[nameId] = ++table->count;
+    *added = 1;
+    return table->count - 1;
+}
+
+static void fillSymbolEntry(SymbolTableEntry *entry, unsigned nameId, const char *name, const char *declType) {
+    entry->nameId = nameId;
+    entry->name = name;
+    entry->type = declType;
+    entry->size = "";
+    entry->hash = calculateHash(name);
+}
+
+// Empty the table but keep its memory, for reuse on the next file: only
+// the index slots in use are cleared, not the whole index.
+static void resetSymbolTable(SymbolTable *table) {
+    for (int i = 0; i < table->count; i++)
+        table->byId[table->entries[i].nameId] = 0;
+    table->count = 0;
+}
+
+static void freeSymbolTable(SymbolTable *table) {
+    free(table->entries);
+    free(table->byId);
+    memset(table, 0, sizeof(*table));
+}
+
+#endif
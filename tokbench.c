@@ -0,0 +1,237 @@
+// Token storage benchmark: memory per token and cost of a pass over the
+// token stream, for the original scanners' Token layout (type and lexeme
+// copied into fixed char arrays), today's Token struct, and the
+// struct-of-arrays TokenBuffer.
+//
+//     gcc -O2 -pthread tokbench.c -o tokbench && ./tokbench file [language]
+//
+// language is javascript, c, java, csharp, ruby or perl; by default it is
+// picked from the file's extension.  Cache misses come from perf_event_open
+// and are shown as n/a where hardware counters are not available.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "languages.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// The Token every scanner returned by value before the shared core.
+typedef struct {
+    int row, col;
+    char type[20];
+    char lexeme[50];
+} LegacyToken;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cacheMissCounter = -1;
+
+static void openCacheMissCounter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    cacheMissCounter = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void startCounting(void) {
+#ifdef __linux__
+    if (cacheMissCounter >= 0) {
+        ioctl(cacheMissCounter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(cacheMissCounter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Cache misses since startCounting(), or -1 if unavailable.
+static long long stopCounting(void) {
+    long long misses = -1;
+#ifdef __linux__
+    if (cacheMissCounter >= 0) {
+        ioctl(cacheMissCounter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(cacheMissCounter, &misses, sizeof(misses)) != sizeof(misses))
+            misses = -1;
+    }
+#endif
+    return misses;
+}
+
+typedef struct {
+    const char *name;
+    double bytesPerToken;
+    double fillSeconds, scanSeconds;
+    long long fillMisses, scanMisses;
+    long checksum;
+} Result;
+
+static void report(const Result *r, size_t tokens) {
+    char fill[32], scan[32];
+    if (r->fillMisses >= 0) {
+        snprintf(fill, sizeof(fill), "%.1f", r->fillMisses * 1000.0 / tokens);
+        snprintf(scan, sizeof(scan), "%.1f", r->scanMisses * 1000.0 / tokens);
+    } else {
+        strcpy(fill, "n/a");
+        strcpy(scan, "n/a");
+    }
+    printf("%-14s %10.1f %10.2f %10.2f %14s %14s %10ld\n", r->name, r->bytesPerToken,
+           r->fillSeconds * 1e9 / tokens, r->scanSeconds * 1e9 / tokens, fill, scan, r->checksum);
+}
+
+// The shape of a collector pass: find declaration keywords and the
+// identifiers after them.
+static Result benchLegacy(const LanguageDescriptor *lang, SourceBuffer *src, size_t count) {
+    Result r = { "legacy Token", sizeof(LegacyToken), 0, 0, 0, 0, 0 };
+    LegacyToken *tokens = malloc(count * sizeof(LegacyToken));
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, src);
+    startCounting();
+    double start = nowSeconds();
+    for (size_t i = 0; i < count; i++) {
+        Token t = getNextToken(&ctx, lang);
+        tokens[i].row = t.row;
+        tokens[i].col = t.col;
+        strcpy(tokens[i].type, tokenKindNames[t.kind]);
+        srcCopyView(src, t.offset, t.length, tokens[i].lexeme, sizeof(tokens[i].lexeme));
+    }
+    r.fillSeconds = nowSeconds() - start;
+    r.fillMisses = stopCounting();
+
+    startCounting();
+    start = nowSeconds();
+    for (size_t i = 0; i + 1 < count; i++) {
+        if (strcmp(tokens[i].type, "keyword") == 0 && strcmp(tokens[i + 1].type, "id") == 0)
+            r.checksum += (long)strlen(tokens[i + 1].lexeme);
+    }
+    r.scanSeconds = nowSeconds() - start;
+    r.scanMisses = stopCounting();
+    free(tokens);
+    return r;
+}
+
+static Result benchTokenArray(const LanguageDescriptor *lang, SourceBuffer *src, size_t count) {
+    Result r = { "Token array", sizeof(Token), 0, 0, 0, 0, 0 };
+    Token *tokens = malloc(count * sizeof(Token));
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, src);
+    startCounting();
+    double start = nowSeconds();
+    for (size_t i = 0; i < count; i++)
+        tokens[i] = getNextToken(&ctx, lang);
+    r.fillSeconds = nowSeconds() - start;
+    r.fillMisses = stopCounting();
+
+    startCounting();
+    start = nowSeconds();
+    for (size_t i = 0; i + 1 < count; i++) {
+        if (tokens[i].kind == TOKEN_KEYWORD && tokens[i + 1].kind == TOKEN_ID)
+            r.checksum += tokens[i + 1].length;
+    }
+    r.scanSeconds = nowSeconds() - start;
+    r.scanMisses = stopCounting();
+    free(tokens);
+    return r;
+}
+
+static Result benchTokenBuffer(const LanguageDescriptor *lang, SourceBuffer *src, int withPositions) {
+    Result r = { withPositions ? "TokenBuffer+rc" : "TokenBuffer", 0, 0, 0, 0, 0, 0 };
+    TokenBuffer tokens;
+    initTokenBuffer(&tokens, withPositions);
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, src);
+    startCounting();
+    double start = nowSeconds();
+    lexTokens(&ctx, lang, &tokens, (size_t)-1);
+    r.fillSeconds = nowSeconds() - start;
+    r.fillMisses = stopCounting();
+    r.bytesPerToken = sizeof(unsigned char) + sizeof(size_t) + sizeof(unsigned) +
+                      (withPositions ? sizeof(TokenPos) : 0);
+
+    startCounting();
+    start = nowSeconds();
+    for (size_t i = 0; i + 1 < tokens.count; i++) {
+        if (tokens.kinds[i] == TOKEN_KEYWORD && tokens.kinds[i + 1] == TOKEN_ID)
+            r.checksum += tokens.lengths[i + 1];
+    }
+    r.scanSeconds = nowSeconds() - start;
+    r.scanMisses = stopCounting();
+    freeTokenBuffer(&tokens);
+    return r;
+}
+
+static const LanguageDescriptor *pickLanguage(const char *path, const char *name) {
+    static const struct { const char *name, *ext; const LanguageDescriptor *lang; } table[] = {
+        { "javascript", ".js", &javascriptLanguage }, { "c", ".c", &cLanguage },
+        { "java", ".java", &javaLanguage }, { "csharp", ".cs", &csharpLanguage },
+        { "ruby", ".rb", &rubyLanguage }, { "perl", ".pl", &perlLanguage },
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (name ? strcmp(name, table[i].name) == 0 : hasExtension(path, table[i].ext))
+            return table[i].lang;
+    }
+    return name ? NULL : &javascriptLanguage;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("usage: %s file [language]\n", argv[0]);
+        return 1;
+    }
+    const LanguageDescriptor *lang = pickLanguage(argv[1], argc > 2 ? argv[2] : NULL);
+    if (!lang) {
+        printf("Unknown language %s\n", argv[2]);
+        return 1;
+    }
+    SourceBuffer src;
+    if (srcOpen(&src, argv[1]) != 0) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    selectScanKernels();
+    openCacheMissCounter();
+
+    // Count first so the arrays are allocated once, outside the timing.
+    size_t count = 0;
+    LexerContext ctx;
+    initLexerContext(&ctx);
+    beginLexing(&ctx, &src);
+    while (getNextToken(&ctx, lang).kind != TOKEN_EOF)
+        count++;
+    if (count < 2) {
+        printf("%s: too few tokens\n", argv[1]);
+        return 1;
+    }
+
+    printf("%s (%s): %zu bytes, %zu tokens\n", argv[1], lang->name, src.len, count);
+    printf("%-14s %10s %10s %10s %14s %14s %10s\n", "Layout", "bytes/tok", "fill ns",
+           "scan ns", "fill miss/1k", "scan miss/1k", "checksum");
+    Result results[] = {
+        benchLegacy(lang, &src, count),
+        benchTokenArray(lang, &src, count),
+        benchTokenBuffer(lang, &src, 1),
+        benchTokenBuffer(lang, &src, 0),
+    };
+    for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++)
+        report(&results[i], count);
+    srcClose(&src);
+    return 0;
+}
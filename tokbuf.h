@@ -0,0 +1,223 @@
+#ifndef TOKBUF_H
+#define TOKBUF_H
+
+/*
+ * Compact token buffer: the whole token stream of a file in
+ * struct-of-arrays form.
+ *
+ * A Token returned by getNextToken is 24 bytes.  Most passes only look at a
+ * token's kind and lexeme, so the buffer keeps each field in its own array
+ * instead.  Kinds are one byte, and lexemes are (offset, length) spans into
+ * the source buffer.  Row/column pairs are a separate array that is only
+ * allocated when asked for (the token dump needs them, symbol collection
+ * does not).  That is 13 bytes per token without positions and 21 with,
+ * and a pass over the kinds touches one byte per token.
+ *
+ * Names are interned in the context's pool (lexctx.h) by tokenId when a
+ * pass first needs one, not as they are lexed: most identifiers are never declared, so
+ * the lexer does not pay for a hash lookup on each of them.
+ *
+ * generateSymbolTable lexes into a buffer a window at a time and hands each
+ * window to the language's collector.  A buffer that only lives for one
+ * pass can take its arrays from an arena (the context's scratch arena)
+ * instead of malloc; they then go when the arena is released.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+
+typedef struct {
+    int row, col;
+} TokenPos;
+
+struct TokenBuffer {
+    unsigned char *kinds;    // TOKEN_*
+    size_t *offsets;         // lexeme spans into the source buffer
+    unsigned *lengths;
+    TokenPos *positions;     // only kept if withPositions
+    size_t count, capacity;
+    int withPositions;
+    Arena *arena;            // where the arrays come from; NULL for malloc
+};
+
+static void initTokenBuffer(TokenBuffer *buf, int withPositions) {
+    memset(buf, 0, sizeof(*buf));
+    buf->withPositions = withPositions;
+}
+
+// realloc, or for a buffer in an arena a bigger copy there (the old array
+// stays until the arena is released).
+static void *growTokenArray(TokenBuffer *buf, void *old, size_t size, size_t capacity) {
+    if (!buf->arena)
+        return realloc(old, capacity * size);
+    void *grown = arenaAllocAligned(buf->arena, capacity * size);
+    if (grown && old)
+        memcpy(grown, old, buf->count * size);
+    return grown;
+}
+
+static int reserveTokenBuffer(TokenBuffer *buf, size_t capacity) {
+    unsigned char *kinds = growTokenArray(buf, buf->kinds, 1, capacity);
+    if (!kinds)
+        return -1;
+    buf->kinds = kinds;
+    size_t *offsets = growTokenArray(buf, buf->offsets, sizeof(size_t), capacity);
+    if (!offsets)
+        return -1;
+    buf->offsets = offsets;
+    unsigned *lengths = growTokenArray(buf, buf->lengths, sizeof(unsigned), capacity);
+    if (!lengths)
+        return -1;
+    buf->lengths = lengths;
+    if (buf->withPositions) {
+        TokenPos *positions = growTokenArray(buf, buf->positions, sizeof(TokenPos), capacity);
+        if (!positions)
+            return -1;
+        buf->positions = positions;
+    }
+    buf->capacity = capacity;
+    return 0;
+}
+
+static int growTokenBuffer(TokenBuffer *buf) {
+    return reserveTokenBuffer(buf, buf->capacity ? buf->capacity * 2 : 4096);
+}
+
+// A buffer whose arrays, room for capacity tokens to start with, come from
+// arena.  Free it by releasing the arena; freeTokenBuffer only forgets it.
+static int initTokenBufferIn(TokenBuffer *buf, Arena *arena, size_t capacity, int withPositions) {
+    initTokenBuffer(buf, withPositions);
+    buf->arena = arena;
+    return reserveTokenBuffer(buf, capacity);
+}
+
+static inline int pushToken(TokenBuffer *buf, const Token *token) {
+    if (buf->count == buf->capacity && growTokenBuffer(buf) != 0)
+        return -1;
+    size_t i = buf->count++;
+    buf->kinds[i] = (unsigned char)token->kind;
+    buf->offsets[i] = token->offset;
+    buf->lengths[i] = (unsigned)token->length;
+    if (buf->withPositions) {
+        buf->positions[i].row = token->row;
+        buf->positions[i].col = token->col;
+    }
+    return 0;
+}
+
+// A copy of src in dst, sized to fit, with its arrays in arena.
+static int copyTokenBufferIn(TokenBuffer *dst, Arena *arena, const TokenBuffer *src) {
+    if (initTokenBufferIn(dst, arena, src->count ? src->count : 1, src->withPositions) != 0)
+        return -1;
+    memcpy(dst->kinds, src->kinds, src->count);
+    memcpy(dst->offsets, src->offsets, src->count * sizeof(size_t));
+    memcpy(dst->lengths, src->lengths, src->count * sizeof(unsigned));
+    if (src->withPositions)
+        memcpy(dst->positions, src->positions, src->count * sizeof(TokenPos));
+    dst->count = src->count;
+    return 0;
+}
+
+static void freeTokenBuffer(TokenBuffer *buf) {
+    if (!buf->arena) {
+        free(buf->kinds);
+        free(buf->offsets);
+        free(buf->lengths);
+        free(buf->positions);
+    }
+    int withPositions = buf->withPositions;
+    memset(buf, 0, sizeof(*buf));
+    buf->withPositions = withPositions;
+}
+
+// Kind of token i; reading past the end gives TOKEN_EOF, like getNextToken.
+static inline int tokenKind(const TokenBuffer *buf, size_t i) {
+    return i < buf->count ? buf->kinds[i] : TOKEN_EOF;
+}
+
+static inline int tokenIs(const TokenBuffer *buf, const SourceBuffer *src, size_t i, const char *s) {
+    return i < buf->count && srcViewEquals(src, buf->offsets[i], (int)buf->lengths[i], s);
+}
+
+// Pool id of token i's lexeme in ctx->src, interning it if needed (0 if
+// out of memory).
+static inline unsigned tokenId(LexerContext *ctx, const TokenBuffer *buf, size_t i) {
+    return internString(&ctx->strings, ctx->src->data + buf->offsets[i], buf->lengths[i]);
+}
+
+// Interned text of token i.
+static inline const char *tokenText(LexerContext *ctx, const TokenBuffer *buf, size_t i) {
+    return internedString(&ctx->strings, tokenId(ctx, buf, i));
+}
+
+// First non-whitespace byte after token i, or EOF (what the original
+// scanners' peekNextChar saw right after reading that token).
+static inline int peekCharAfter(const TokenBuffer *buf, const SourceBuffer *src, size_t i) {
+    size_t pos = buf->offsets[i] + buf->lengths[i];
+    while (pos < src->len && isSpaceByte((unsigned char)src->data[pos]))
+        pos++;
+    return pos < src->len ? (unsigned char)src->data[pos] : EOF;
+}
+
+// Append tokens to buf until it holds max of them or the input runs out.
+// Returns 1 at end of input, 0 if buf filled up, -1 if out of memory.
+int lexTokens(LexerContext *ctx, const LanguageDescriptor *lang, TokenBuffer *buf, size_t max) {
+    while (buf->count < max) {
+        Token token = getNextToken(ctx, lang);
+        if (token.kind == TOKEN_EOF)
+            return 1;
+        if (pushToken(buf, &token) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+// printTokens() output for a buffer lexed with positions.
+void printTokenBuffer(const SourceBuffer *src, const TokenBuffer *tokens) {
+    emitTokenHeader();
+    for (size_t i = 0; i < tokens->count; i++) {
+        emitToken(tokens->kinds[i], src->data + tokens->offsets[i], tokens->lengths[i], tokens->positions[i].row,
+                  tokens->positions[i].col);
+    }
+}
+
+/*
+ * Lex and collect a window of tokens at a time rather than the whole file,
+ * so the buffer stays small and the collector reads tokens while they are
+ * still in cache.  A window ends one token early to leave the collector its
+ * lookahead; whatever it did not consume moves to the front of the next.
+ */
+#ifndef SYMBOL_WINDOW_TOKENS
+#define SYMBOL_WINDOW_TOKENS 8192   // at least 2
+#endif
+
+void generateSymbolTable(LexerContext *ctx, const LanguageDescriptor *lang, SourceBuffer *src) {
+    TokenBuffer tokens;
+    ArenaMark mark = arenaMark(&ctx->scratch);
+    if (initTokenBufferIn(&tokens, &ctx->scratch, SYMBOL_WINDOW_TOKENS, 0) != 0)
+        return;
+    beginLexing(ctx, src);
+
+    int status = 0;
+    while (status == 0) {
+        LEXSTATS(uint64_t start = lexTicks();)
+        status = lexTokens(ctx, lang, &tokens, SYMBOL_WINDOW_TOKENS);
+        LEXSTATS(uint64_t lexed = lexTicks();)
+        size_t end = status != 0 ? tokens.count : tokens.count - 1;
+        size_t next = lang->collectSymbols(ctx, lang, &tokens, 0, end);
+        LEXSTATS(lexStats.windows++; lexHistogramAdd(&lexStats.windowLexTicks, lexed - start);
+                 lexHistogramAdd(&lexStats.windowCollectTicks, lexTicks() - lexed);)
+        size_t keep = next < tokens.count ? tokens.count - next : 0;
+        if (keep) {
+            memmove(tokens.kinds, tokens.kinds + next, keep);
+            memmove(tokens.offsets, tokens.offsets + next, keep * sizeof(size_t));
+            memmove(tokens.lengths, tokens.lengths + next, keep * sizeof(unsigned));
+        }
+        tokens.count = keep;
+    }
+    arenaRelease(&ctx->scratch, mark);
+}
+
+#endif
@@ -0,0 +1,81 @@
+// Reader for the binary token-stream files written by --binary (tokfile.h):
+// prints them back as the <lexeme, row, col> listing --tokens gives.
+//
+//     gcc -O2 tokdump.c -o tokdump
+//     ./tokdump file [--stats] [--format text | csv | jsonl]
+//
+// The file is mapped and read in place.  --stats prints a summary (tokens,
+// distinct lexemes, bytes per section and per token, tokens of each kind)
+// instead of the listing; --format writes the listing as CSV or JSON Lines
+// like the front ends do.
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "toklist.h"
+#include "tokfile.h"
+
+static int printStats(const TokenFile *f) {
+    const TokenFileHeader *h = f->header;
+    uint64_t byKind[256] = { 0 };
+    for (uint64_t i = 0; i < h->tokenCount; i++)
+        byKind[f->kinds[i]]++;
+    printf("%.16s tokens, format %u\n", h->language, h->version);
+    printf("%llu tokens, %llu distinct lexemes\n", (unsigned long long)h->tokenCount,
+           (unsigned long long)h->lexemeCount);
+    printf("%zu bytes: %llu pool, %llu records (%.2f per token)\n", f->file.len,
+           (unsigned long long)h->poolBytes, (unsigned long long)h->recordsBytes,
+           h->tokenCount ? (double)f->file.len / h->tokenCount : 0.0);
+    for (int k = 0; k < 256; k++) {
+        if (byKind[k])
+            printf("%-10s %llu\n", k < TOKEN_NUM_KINDS ? tokenKindNames[k] : "?", (unsigned long long)byKind[k]);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    int stats = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if ((output.format = outputFormat(argv[++i])) < 0) {
+                printf("Unknown format %s (text, csv or jsonl)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        printf("usage: %s file [--stats] [--format text | csv | jsonl]\n", argv[0]);
+        return 1;
+    }
+
+    TokenFile f;
+    int status = openTokenFile(&f, path);
+    if (status != 0) {
+        printf(status == -1 ? "Cannot open %s\n" : "%s is not a token file this version can read\n", path);
+        return 1;
+    }
+    if (stats) {
+        printStats(&f);
+        closeTokenFile(&f);
+        return 0;
+    }
+
+    TokenFileCursor cursor;
+    FileToken t;
+    startTokenFileCursor(&cursor, &f);
+    emitTokenHeader();
+    while ((status = nextFileToken(&cursor, &t)) > 0)
+        emitToken(t.kind < TOKEN_NUM_KINDS ? t.kind : TOKEN_UNKNOWN, t.text, t.length, t.row, t.col);
+    outFlush(&output);
+    closeTokenFile(&f);
+    if (status < 0) {
+        fprintf(stderr, "%s: corrupt token records\n", path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+#ifndef TOKFILE_H
+#define TOKFILE_H
+
+/*
+ * Binary token-stream files (--binary), for tools that would otherwise
+ * re-parse the <lexeme, row, col> listing.
+ *
+ * A file is a fixed header followed by four sections:
+ *
+ *     kinds     one TOKEN_* byte per token
+ *     lexemes   lexemeCount + 1 uint32 offsets into the pool (4-aligned);
+ *               lexeme k is pool[lexemes[k] .. lexemes[k + 1])
+ *     pool      the bytes of every distinct lexeme, each stored once
+ *     records   per token, three LEB128 varints: the row delta, the column
+ *               (the delta from the previous token's column, zigzag
+ *               encoded, on the same row; the column itself on a new row)
+ *               and the lexeme number
+ *
+ * Rows and columns are almost always small deltas and most lexemes repeat,
+ * so a token takes a handful of bytes, about a third of its text listing.  The file is read in place: the
+ * reader maps it and hands out pointers into the pool, and only the
+ * records need decoding, front to back.  The kinds can be scanned without
+ * decoding anything.
+ *
+ * Like the symbol cache, the format is native-endian; the header records
+ * the byte order and the version, and readers reject anything else.
+ * Converting a file back to text (tokdump.c) gives exactly what --tokens
+ * prints.
+ *
+ * This header has the format and the reader, which need nothing but the
+ * mapped file; the writer, which runs over a lexed TokenBuffer, is in
+ * tokwrite.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "srcbuf.h"
+
+#define TOKFILE_MAGIC "LEXTOKS"
+#define TOKFILE_VERSION 1
+
+typedef struct {
+    char magic[8];             // TOKFILE_MAGIC
+    uint32_t version;          // TOKFILE_VERSION
+    uint32_t byteOrder;        // 0x01020304 as written
+    char language[16];         // LanguageDescriptor.name, NUL-padded
+    uint64_t tokenCount, lexemeCount;
+    uint64_t kindsOffset, lexemesOffset;
+    uint64_t poolOffset, poolBytes;
+    uint64_t recordsOffset, recordsBytes;
+} TokenFileHeader;
+
+typedef struct {
+    SourceBuffer file;             // the mapped file
+    const TokenFileHeader *header;
+    const unsigned char *kinds;
+    const uint32_t *lexemes;
+    const char *pool;
+    const unsigned char *records, *recordsEnd;
+} TokenFile;
+
+typedef struct {
+    int kind, row, col;
+    const char *text;              // points into the mapping; not NUL-terminated
+    unsigned length;
+    unsigned lexeme;               // equal lexemes have equal numbers
+} FileToken;
+
+typedef struct {
+    const TokenFile *file;
+    const unsigned char *p;
+    uint64_t index;
+    int row, col;
+} TokenFileCursor;
+
+void closeTokenFile(TokenFile *f) {
+    if (f->file.data)
+        srcClose(&f->file);
+    memset(f, 0, sizeof(*f));
+}
+
+static int sectionInFile(const TokenFile *f, uint64_t offset, uint64_t count, size_t size) {
+    return offset <= f->file.len && count <= (f->file.len - offset) / size;
+}
+
+// Map path and check its header and section bounds.  Returns 0, -1 if it
+// cannot be opened, -2 if it is not a token file this reader understands.
+int openTokenFile(TokenFile *f, const char *path) {
+    memset(f, 0, sizeof(*f));
+    if (srcOpen(&f->file, path) != 0) {
+        f->file.data = NULL;
+        return -1;
+    }
+    const TokenFileHeader *h = (const TokenFileHeader *)f->file.data;
+    int ok = f->file.len >= sizeof(*h) && memcmp(h->magic, TOKFILE_MAGIC, sizeof(TOKFILE_MAGIC)) == 0 &&
+             h->version == TOKFILE_VERSION && h->byteOrder == 0x01020304 && h->lexemesOffset % 4 == 0 &&
+             sectionInFile(f, h->kindsOffset, h->tokenCount, 1) &&
+             sectionInFile(f, h->lexemesOffset, h->lexemeCount + 1, sizeof(uint32_t)) &&
+             sectionInFile(f, h->poolOffset, h->poolBytes, 1) &&
+             sectionInFile(f, h->recordsOffset, h->recordsBytes, 1);
+    if (ok) {
+        f->header = h;
+        f->kinds = (const unsigned char *)f->file.data + h->kindsOffset;
+        f->lexemes = (const uint32_t *)(f->file.data + h->lexemesOffset);
+        f->pool = f->file.data + h->poolOffset;
+        f->records = (const unsigned char *)f->file.data + h->recordsOffset;
+        f->recordsEnd = f->records + h->recordsBytes;
+        ok = f->lexemes[h->lexemeCount] == h->poolBytes;
+    }
+    if (!ok) {
+        closeTokenFile(f);
+        return -2;
+    }
+    return 0;
+}
+
+void startTokenFileCursor(TokenFileCursor *c, const TokenFile *f) {
+    c->file = f;
+    c->p = f->records;
+    c->index = 0;
+    c->row = 1;
+    c->col = 1;
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline int getVarint(TokenFileCursor *c, uint64_t *v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && c->p < c->file->recordsEnd; shift += 7) {
+        unsigned char byte = *c->p++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *v = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Decode the next token.  Returns 1 with *t filled in, 0 at the end, or
+// -1 if the records are corrupt.
+int nextFileToken(TokenFileCursor *c, FileToken *t) {
+    const TokenFile *f = c->file;
+    if (c->index == f->header->tokenCount)
+        return 0;
+    uint64_t rowDelta, colValue, k;
+    if (getVarint(c, &rowDelta) != 0 || getVarint(c, &colValue) != 0 || getVarint(c, &k) != 0 ||
+        k >= f->header->lexemeCount || f->lexemes[k] > f->lexemes[k + 1] ||
+        f->lexemes[k + 1] > f->header->poolBytes)
+        return -1;
+    int64_t delta = unzigzag(rowDelta);
+    c->row += (int)delta;
+    c->col = delta == 0 ? c->col + (int)unzigzag(colValue) : (int)colValue;
+    t->kind = f->kinds[c->index++];
+    t->row = c->row;
+    t->col = c->col;
+    t->lexeme = (unsigned)k;
+    t->text = f->pool + f->lexemes[k];
+    t->length = f->lexemes[k + 1] - f->lexemes[k];
+    return 1;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef TOKLIST_H
+#define TOKLIST_H
+
+/*
+ * Token kinds and the rows of the token listing, kept apart from the
+ * scanner so that tools which only print tokens read back from a file
+ * (tokdump.c) need not pull in the lexer, its context and symbol table.
+ */
+
+#include <string.h>
+#include "outbuf.h"
+
+// Token kinds, small enough to store in a byte (see tokbuf.h).
+enum {
+    TOKEN_KEYWORD,
+    TOKEN_ID,
+    TOKEN_VARIABLE,   // sigil-prefixed identifier (Perl)
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_OPERATOR,
+    TOKEN_UNKNOWN,
+    TOKEN_DIRECTIVE,  // a whole preprocessor line, '#' to the end of line (C)
+    TOKEN_EOF,
+    TOKEN_NUM_KINDS
+};
+
+static const char *const tokenKindNames[TOKEN_NUM_KINDS] = {
+    "keyword", "id", "variable", "string", "number", "operator", "unknown", "directive", "EOF"
+};
+
+/*
+ * Rows of the token listing, written to output in its format.  Text is
+ * exactly what the original printf calls produced; CSV and JSON Lines
+ * carry the same fields plus the token kind.
+ */
+
+void emitTokenHeader(void) {
+    if (output.format == OUTPUT_TEXT)
+        outString(&output, "Token\t\tRow\tColumn\n-----------------------------\n");
+    else if (output.format == OUTPUT_CSV)
+        outString(&output, "lexeme,row,col,kind\n");
+}
+
+void emitToken(int kind, const char *text, size_t length, int row, int col) {
+    OutputWriter *w = &output;
+    if (w->format == OUTPUT_TEXT) {
+        // printf's %.*s stopped at a NUL byte; the listing still does.
+        const char *nul = memchr(text, '\0', length);
+        outChar(w, '<');
+        outBytes(w, text, nul ? (size_t)(nul - text) : length);
+        outBytes(w, ", ", 2);
+        outInt(w, row);
+        outBytes(w, ", ", 2);
+        outInt(w, col);
+        outBytes(w, ">\n", 2);
+    } else if (w->format == OUTPUT_CSV) {
+        outCsvField(w, text, length);
+        outChar(w, ',');
+        outInt(w, row);
+        outChar(w, ',');
+        outInt(w, col);
+        outChar(w, ',');
+        outString(w, tokenKindNames[kind]);
+        outChar(w, '\n');
+    } else {
+        outString(w, "{\"lexeme\":");
+        outJsonString(w, text, length);
+        outString(w, ",\"row\":");
+        outInt(w, row);
+        outString(w, ",\"col\":");
+        outInt(w, col);
+        outString(w, ",\"kind\":\"");
+        outString(w, tokenKindNames[kind]);
+        outString(w, "\"}\n");
+    }
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef TOKWRITE_H
+#define TOKWRITE_H
+
+/*
+ * Writer for the binary token-stream files of tokfile.h (--binary).  The
+ * sections are built up in memory as tokens arrive, distinct lexemes are
+ * found through a hash table over the pool, and finishTokenFile lays the
+ * file out and writes it in one go.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "lexer.h"
+#include "tokbuf.h"
+#include "bytebuf.h"
+#include "tokfile.h"
+
+static inline int putVarint(ByteBuffer *b, uint64_t v) {
+    if (b->capacity - b->len < 10 && reserveBytes(b, 10) != 0)
+        return -1;
+    while (v >= 0x80) {
+        b->data[b->len++] = (char)(v | 0x80);
+        v >>= 7;
+    }
+    b->data[b->len++] = (char)v;
+    return 0;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+typedef struct {
+    char language[16];
+    ByteBuffer kinds, pool, records;
+    uint32_t *lexemes;             // pool offsets, lexemeCount + 1 of them
+    uint32_t *slots;               // lexeme number + 1 by hash, 0 = empty
+    unsigned lexemeCount, lexemeCapacity, slotMask;
+    uint64_t tokenCount;
+    int row, col;                  // previous token's position
+} TokenFileWriter;
+
+int initTokenFileWriter(TokenFileWriter *w, const char *language) {
+    memset(w, 0, sizeof(*w));
+    strncpy(w->language, language, sizeof(w->language) - 1);
+    w->row = 1;
+    w->col = 1;
+    w->lexemes = malloc(1024 * sizeof(uint32_t));
+    w->slots = calloc(1024, sizeof(uint32_t));
+    if (!w->lexemes || !w->slots)
+        return -1;
+    w->lexemes[0] = 0;
+    w->lexemeCapacity = 1023;
+    w->slotMask = 1023;
+    return 0;
+}
+
+void freeTokenFileWriter(TokenFileWriter *w) {
+    free(w->kinds.data);
+    free(w->pool.data);
+    free(w->records.data);
+    free(w->lexemes);
+    free(w->slots);
+    memset(w, 0, sizeof(*w));
+}
+
+static int growLexemeSlots(TokenFileWriter *w) {
+    unsigned size = (w->slotMask + 1) * 2;
+    uint32_t *slots = calloc(size, sizeof(uint32_t));
+    if (!slots)
+        return -1;
+    for (unsigned k = 0; k < w->lexemeCount; k++) {
+        const char *s = (const char *)w->pool.data + w->lexemes[k];
+        unsigned slot = hashBytes(s, w->lexemes[k + 1] - w->lexemes[k]) & (size - 1);
+        while (slots[slot])
+            slot = (slot + 1) & (size - 1);
+        slots[slot] = k + 1;
+    }
+    free(w->slots);
+    w->slots = slots;
+    w->slotMask = size - 1;
+    return 0;
+}
+
+// Number of the lexeme s[0..len), adding it to the pool if it is new;
+// -1 if out of memory or the pool would pass 4 GiB.  Lexemes may contain
+// NUL bytes, so they are compared by length and memcmp.
+static long long addLexeme(TokenFileWriter *w, const char *s, unsigned len) {
+    unsigned slot = hashBytes(s, len) & w->slotMask;
+    for (uint32_t k; (k = w->slots[slot]) != 0; slot = (slot + 1) & w->slotMask) {
+        uint32_t start = w->lexemes[k - 1];
+        if (w->lexemes[k] - start == len && memcmp(w->pool.data + start, s, len) == 0)
+            return k - 1;
+    }
+    if (w->pool.len + len > UINT32_MAX || reserveBytes(&w->pool, len) != 0)
+        return -1;
+    if (w->lexemeCount + 1 == w->lexemeCapacity) {
+        unsigned capacity = w->lexemeCapacity * 2 + 1;
+        uint32_t *lexemes = realloc(w->lexemes, (capacity + 1) * sizeof(uint32_t));
+        if (!lexemes)
+            return -1;
+        w->lexemes = lexemes;
+        w->lexemeCapacity = capacity;
+    }
+    memcpy(w->pool.data + w->pool.len, s, len);
+    w->pool.len += len;
+    unsigned k = w->lexemeCount++;
+    w->lexemes[k + 1] = (uint32_t)w->pool.len;
+    w->slots[slot] = k + 1;
+    // Keep the load factor at or below 1/2.
+    if (w->lexemeCount * 2 > w->slotMask + 1 && growLexemeSlots(w) != 0)
+        return -1;
+    return k;
+}
+
+int writeFileToken(TokenFileWriter *w, int kind, const char *lexeme, unsigned length, int row, int col) {
+    long long k = addLexeme(w, lexeme, length);
+    if (k < 0 || reserveBytes(&w->kinds, 1) != 0)
+        return -1;
+    w->kinds.data[w->kinds.len++] = (char)kind;
+    int64_t rowDelta = (int64_t)row - w->row;
+    if (putVarint(&w->records, zigzag(rowDelta)) != 0 ||
+        putVarint(&w->records, rowDelta == 0 ? zigzag((int64_t)col - w->col) : (uint64_t)col) != 0 ||
+        putVarint(&w->records, (uint64_t)k) != 0)
+        return -1;
+    w->row = row;
+    w->col = col;
+    w->tokenCount++;
+    return 0;
+}
+
+// All of a buffer lexed with positions.
+int writeTokenBuffer(TokenFileWriter *w, const SourceBuffer *src, const TokenBuffer *tokens) {
+    for (size_t i = 0; i < tokens->count; i++) {
+        if (writeFileToken(w, tokens->kinds[i], src->data + tokens->offsets[i], tokens->lengths[i],
+                           tokens->positions[i].row, tokens->positions[i].col) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int writeSection(FILE *fp, uint64_t *at, uint64_t offset, const void *data, size_t len) {
+    static const char zeros[8];
+    size_t pad = (size_t)(offset - *at);
+    if ((pad && fwrite(zeros, 1, pad, fp) != pad) || (len && fwrite(data, 1, len, fp) != len))
+        return -1;
+    *at = offset + len;
+    return 0;
+}
+
+static uint64_t align8(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+// Write the finished file to fp.  Every section is already in memory, so
+// the layout is worked out first and fp may be a pipe.  Returns 0, or -1 on
+// a write error.
+int finishTokenFile(TokenFileWriter *w, FILE *fp) {
+    TokenFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TOKFILE_MAGIC, sizeof(TOKFILE_MAGIC));
+    h.version = TOKFILE_VERSION;
+    h.byteOrder = 0x01020304;
+    memcpy(h.language, w->language, sizeof(h.language));
+    h.tokenCount = w->tokenCount;
+    h.lexemeCount = w->lexemeCount;
+    h.poolBytes = w->pool.len;
+    h.recordsBytes = w->records.len;
+    size_t lexemeBytes = (w->lexemeCount + 1) * sizeof(uint32_t);
+    h.kindsOffset = align8(sizeof(h));
+    h.lexemesOffset = align8(h.kindsOffset + w->kinds.len);
+    h.poolOffset = align8(h.lexemesOffset + lexemeBytes);
+    h.recordsOffset = align8(h.poolOffset + w->pool.len);
+
+    uint64_t at = 0;
+    if (writeSection(fp, &at, 0, &h, sizeof(h)) != 0 ||
+        writeSection(fp, &at, h.kindsOffset, w->kinds.data, w->kinds.len) != 0 ||
+        writeSection(fp, &at, h.lexemesOffset, w->lexemes, lexemeBytes) != 0 ||
+        writeSection(fp, &at, h.poolOffset, w->pool.data, w->pool.len) != 0 ||
+        writeSection(fp, &at, h.recordsOffset, w->records.data, w->records.len) != 0)
+        return -1;
+    return fflush(fp) == 0 ? 0 : -1;
+}
+
+#endif